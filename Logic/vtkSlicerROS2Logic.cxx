@@ -19,6 +19,7 @@
 // SlicerROS2 Logic includes
 #include <SlicerROS2Config.h>
 #include <vtkSlicerROS2Logic.h>
+#include <vtkSlicerROS2LogicInternals.h>
 #include <qSlicerCoreApplication.h>
 
 // VTK includes
@@ -36,9 +37,14 @@
 
 // MRMLROS2
 #include <vtkMRMLROS2Utils.h>
+#include <vtkMRMLROS2TimeStatistics.h>
+#include <vtkMRMLROS2Tracer.h>
 #include <vtkMRMLROS2NodeNode.h>
+#include <vtkMRMLROS2NodeInternals.h>
 #include <vtkMRMLROS2SubscriberDefaultNodes.h>
+#include <vtkMRMLROS2GenericSubscriberNode.h>
 #include <vtkMRMLROS2PublisherDefaultNodes.h>
+#include <vtkMRMLROS2GenericPublisherNode.h>
 #include <vtkMRMLROS2ParameterNode.h>
 #include <vtkMRMLROS2Tf2BroadcasterNode.h>
 #include <vtkMRMLROS2Tf2LookupNode.h>
@@ -56,13 +62,17 @@ vtkStandardNewMacro(vtkSlicerROS2Logic);
 vtkSlicerROS2Logic::vtkSlicerROS2Logic()
 {
   mTimerLog = vtkSmartPointer<vtkTimerLog>::New();
+  mSpinStatistics = vtkSmartPointer<vtkMRMLROS2TimeStatistics>::New();
   vtkMRMLROS2::ROSInit();
+  // executor requires an initialized context
+  mInternals = std::make_unique<vtkSlicerROS2LogicInternals>();
 }
 
 
 //----------------------------------------------------------------------------
 vtkSlicerROS2Logic::~vtkSlicerROS2Logic()
 {
+  mInternals.reset();
   vtkMRMLROS2::ROSShutdown();
 }
 
@@ -107,8 +117,12 @@ void vtkSlicerROS2Logic::RegisterNodes(void)
   this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2SubscriberDoubleArrayNode>::New());
   this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2SubscriberIntTableNode>::New());
   this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2SubscriberDoubleTableNode>::New());
+  this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2SubscriberIntTensorNode>::New());
+  this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2SubscriberDoubleTensorNode>::New());
   this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2SubscriberPoseStampedNode>::New());
   this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2SubscriberJoyNode>::New());
+  this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2SubscriberImageNode>::New());
+  this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2GenericSubscriberNode>::New());
   // Publishers
   this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2PublisherStringNode>::New());
   this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2PublisherBoolNode>::New());
@@ -119,10 +133,14 @@ void vtkSlicerROS2Logic::RegisterNodes(void)
   this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2PublisherDoubleArrayNode>::New());
   this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2PublisherIntTableNode>::New());
   this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2PublisherDoubleTableNode>::New());
+  this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2PublisherIntTensorNode>::New());
+  this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2PublisherDoubleTensorNode>::New());
   this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2PublisherPoseStampedNode>::New());
   this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2PublisherWrenchStampedNode>::New());
   this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2PublisherPoseArrayNode>::New());
   this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2PublisherUInt8ImageNode>::New());
+  this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2PublisherImageNode>::New());
+  this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2GenericPublisherNode>::New());
 #if USE_CISST_MSGS
   this->GetMRMLScene()->RegisterNodeClass(vtkSmartPointer<vtkMRMLROS2PublisherCartesianImpedanceGainsNode>::New());
 #endif
@@ -163,19 +181,316 @@ void vtkSlicerROS2Logic::OnMRMLSceneNodeRemoved(vtkMRMLNode* node)
     if (it != mROS2Nodes.end()) {
       mROS2Nodes.erase(it);
     }
+    auto executorIt = mInternals->mNodesInExecutor.find(rosNode);
+    if (executorIt != mInternals->mNodesInExecutor.end()) {
+      mInternals->mExecutor->remove_node(executorIt->second);
+      mInternals->mNodesInExecutor.erase(executorIt);
+    }
+  }
+}
+
+
+void vtkSlicerROS2Logic::UpdateExecutorNodes(void)
+{
+  // ROS nodes can be added to the scene before their internal ROS
+  // node is created (Create is called after AddNode)
+  for (auto & n : mROS2Nodes) {
+    std::shared_ptr<rclcpp::Node> nodePointer = nullptr;
+    if (n->mInternals) {
+      nodePointer = n->mInternals->mNodePointer;
+    }
+    auto it = mInternals->mNodesInExecutor.find(n);
+    if (it == mInternals->mNodesInExecutor.end()) {
+      if (nodePointer) {
+        mInternals->mExecutor->add_node(nodePointer);
+        mInternals->mNodesInExecutor[n] = nodePointer;
+      }
+    } else if (it->second != nodePointer) {
+      mInternals->mExecutor->remove_node(it->second);
+      if (nodePointer) {
+        mInternals->mExecutor->add_node(nodePointer);
+        it->second = nodePointer;
+      } else {
+        mInternals->mNodesInExecutor.erase(it);
+      }
+    }
   }
 }
 
 
 void vtkSlicerROS2Logic::Spin(void)
 {
+  // declared first so the render blocker release is part of the trace
+  vtkMRMLROS2Tracer::Scope trace("logic", "Spin");
   mTimerLog->StartTimer();
   SlicerRenderBlocker renderBlocker;
-  for (auto & n : mROS2Nodes) {
-    n->Spin();
+  // all pending background messages are handled by this spin
+  vtkMRMLROS2::ClearWakeup();
+  mNumberOfSpins++;
+
+  const bool hasBudget = (mSpinBudget > 0.0);
+  std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+  if (hasBudget) {
+    deadline = std::chrono::steady_clock::now()
+      + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(mSpinBudget));
+  }
+
+  if (rclcpp::ok()) {
+    UpdateExecutorNodes();
+  }
+
+  // time spent on each ROS node, in both passes
+  std::vector<double> nodeDurations(mROS2Nodes.size(), 0.0);
+
+  // high priority first: tf2 lookups (including robot links) and parameters
+  bool running = false;
+  vtkMRMLROS2Tracer::Begin("logic", "PriorityNodes");
+  for (size_t index = 0; index < mROS2Nodes.size(); ++index) {
+    const double start = vtkMRMLROS2TimeStatistics::Now();
+    running = mROS2Nodes[index]->SpinPriorityNodes() || running;
+    nodeDurations[index] = vtkMRMLROS2TimeStatistics::Now() - start;
+  }
+  vtkMRMLROS2Tracer::End("logic", "PriorityNodes");
+
+  if (running) {
+    bool budgetExceeded = false;
+    // messages received in background
+    for (size_t index = 0; index < mROS2Nodes.size(); ++index) {
+      auto & n = mROS2Nodes[index];
+      if (n->GetSpinInBackground()) {
+        vtkMRMLROS2Tracer::Scope traceNode("logic", "BackgroundSubscribers", n->GetROS2NodeName());
+        const double start = vtkMRMLROS2TimeStatistics::Now();
+        if (!n->SpinBackgroundSubscribers(deadline)) {
+          budgetExceeded = true;
+        }
+        nodeDurations[index] += vtkMRMLROS2TimeStatistics::Now() - start;
+      }
+    }
+    if (budgetExceeded) {
+      // make sure we get called again for the messages left in background
+      vtkMRMLROS2::NotifyWakeup();
+    }
+    // all ROS callbacks, except the ones handled by background threads
+    vtkMRMLROS2Tracer::Scope traceExecutor("logic", "ExecutorSpinSome");
+    if (!hasBudget) {
+      mInternals->mExecutor->spin_some();
+    } else {
+      const auto remaining = deadline - std::chrono::steady_clock::now();
+      if (remaining > std::chrono::steady_clock::duration::zero()) {
+        mInternals->mExecutor->spin_some(std::chrono::duration_cast<std::chrono::nanoseconds>(remaining));
+      } else {
+        // budget used by the priority nodes, still execute one ready
+        // callback so the executor can't be starved
+        mInternals->mExecutor->spin_once(std::chrono::nanoseconds(0));
+      }
+      if (std::chrono::steady_clock::now() >= deadline) {
+        budgetExceeded = true;
+      }
+    }
+    if (budgetExceeded) {
+      mNumberOfSpinBudgetOverruns++;
+    }
+  }
+
+  // one Modified event per subscriber coalescing its messages, MRML
+  // nodes driven by subscribers and then MRML nodes observed by
+  // publishers, including the ones modified by the subscribers
+  for (size_t index = 0; index < mROS2Nodes.size(); ++index) {
+    const double start = vtkMRMLROS2TimeStatistics::Now();
+    mROS2Nodes[index]->FlushModifiedEvents();
+    mROS2Nodes[index]->UpdateDrivenNodes();
+    mROS2Nodes[index]->PublishObservedNodes();
+    nodeDurations[index] += vtkMRMLROS2TimeStatistics::Now() - start;
+    mROS2Nodes[index]->mSpinStatistics->AddSample(nodeDurations[index]);
   }
+
   mTimerLog->StopTimer();
-  // std::cout << mTimerLog->GetElapsedTime() * 1000.0 << "ms" << std::endl; - commented out for development
+  mSpinStatistics->AddSample(mTimerLog->GetElapsedTime() * 1000.0);
+}
+
+
+vtkMRMLROS2TimeStatistics * vtkSlicerROS2Logic::GetSpinStatistics(void)
+{
+  return mSpinStatistics;
+}
+
+
+void vtkSlicerROS2Logic::SetSpinBudget(const double & milliseconds)
+{
+  if (milliseconds < 0.0) {
+    vtkErrorMacro(<< "SetSpinBudget: budget can't be negative, use 0 for no limit");
+    return;
+  }
+  mSpinBudget = milliseconds;
+}
+
+
+void vtkSlicerROS2Logic::ResetSpinCounters(void)
+{
+  mNumberOfSpins = 0;
+  mNumberOfSpinBudgetOverruns = 0;
+}
+
+
+int vtkSlicerROS2Logic::LoadComponent(const std::string & packageName, const std::string & pluginName,
+                                      const std::string & nodeName, const std::string & nodeNamespace,
+                                      const bool & intraProcess)
+{
+  if (!rclcpp::ok()) {
+    vtkErrorMacro(<< "LoadComponent: ROS is not running, unable to load \"" << pluginName << "\"");
+    return 0;
+  }
+  if (!mInternals->mComponentManager) {
+    mInternals->mComponentManager
+      = std::make_shared<vtkSlicerROS2ComponentManager>(mInternals->mExecutor, "slicer_component_manager");
+    mInternals->mExecutor->add_node(mInternals->mComponentManager);
+  }
+  std::string errorMessage;
+  const uint64_t componentId = mInternals->mComponentManager->Load(packageName, pluginName,
+                                                                   nodeName, nodeNamespace,
+                                                                   intraProcess, errorMessage);
+  if (componentId == 0) {
+    vtkErrorMacro(<< "LoadComponent: unable to load \"" << pluginName
+                  << "\" from package \"" << packageName << "\", " << errorMessage);
+    ReleaseComponentManagerIfUnused();
+    return 0;
+  }
+  return static_cast<int>(componentId);
+}
+
+
+void vtkSlicerROS2Logic::ReleaseComponentManagerIfUnused(void)
+{
+  // the container services would otherwise require polling
+  if (mInternals->mComponentManager
+      && (mInternals->mComponentManager->GetNumberOfComponents() == 0)) {
+    mInternals->mExecutor->remove_node(mInternals->mComponentManager);
+    mInternals->mComponentManager.reset();
+  }
+}
+
+
+bool vtkSlicerROS2Logic::UnloadComponent(const int & componentId)
+{
+  if (!mInternals->mComponentManager) {
+    vtkErrorMacro(<< "UnloadComponent: no component has been loaded");
+    return false;
+  }
+  std::string errorMessage;
+  if (!mInternals->mComponentManager->Unload(componentId, errorMessage)) {
+    vtkErrorMacro(<< "UnloadComponent: " << errorMessage);
+    return false;
+  }
+  ReleaseComponentManagerIfUnused();
+  return true;
+}
+
+
+int vtkSlicerROS2Logic::GetNumberOfComponents(void) const
+{
+  if (!mInternals->mComponentManager) {
+    return 0;
+  }
+  return static_cast<int>(mInternals->mComponentManager->GetNumberOfComponents());
+}
+
+
+bool vtkSlicerROS2Logic::StartTrace(const std::string & fileName, const int & maximumNumberOfEvents)
+{
+  if (maximumNumberOfEvents <= 0) {
+    vtkErrorMacro(<< "StartTrace: maximum number of events must be strictly positive");
+    return false;
+  }
+  std::string errorMessage;
+  if (!vtkMRMLROS2Tracer::Start(fileName, static_cast<size_t>(maximumNumberOfEvents), errorMessage)) {
+    vtkErrorMacro(<< "StartTrace: " << errorMessage);
+    return false;
+  }
+  return true;
+}
+
+
+bool vtkSlicerROS2Logic::StopTrace(void)
+{
+  std::string errorMessage;
+  if (!vtkMRMLROS2Tracer::Stop(errorMessage)) {
+    vtkErrorMacro(<< "StopTrace: " << errorMessage);
+    return false;
+  }
+  const size_t dropped = vtkMRMLROS2Tracer::GetNumberOfDroppedEvents();
+  if (dropped != 0) {
+    vtkWarningMacro(<< "StopTrace: trace buffer full, " << dropped
+                    << " events dropped, use a larger maximum number of events for StartTrace");
+  }
+  return true;
+}
+
+
+bool vtkSlicerROS2Logic::IsTracing(void) const
+{
+  return vtkMRMLROS2Tracer::IsRecording();
+}
+
+
+int vtkSlicerROS2Logic::GetNumberOfDroppedTraceEvents(void) const
+{
+  return static_cast<int>(vtkMRMLROS2Tracer::GetNumberOfDroppedEvents());
+}
+
+
+void vtkSlicerROS2Logic::TraceBegin(const std::string & category, const std::string & name)
+{
+  vtkMRMLROS2Tracer::Begin(category, name);
+}
+
+
+void vtkSlicerROS2Logic::TraceEnd(const std::string & category, const std::string & name)
+{
+  vtkMRMLROS2Tracer::End(category, name);
+}
+
+
+void vtkSlicerROS2Logic::SetMaximumSpinRate(const double & rate)
+{
+  if (rate <= 0.0) {
+    vtkErrorMacro(<< "SetMaximumSpinRate: rate must be strictly positive");
+    return;
+  }
+  mMaximumSpinRate = rate;
+}
+
+
+void vtkSlicerROS2Logic::SetIdleSpinRate(const double & rate)
+{
+  if (rate <= 0.0) {
+    vtkErrorMacro(<< "SetIdleSpinRate: rate must be strictly positive");
+    return;
+  }
+  mIdleSpinRate = rate;
+}
+
+
+bool vtkSlicerROS2Logic::RequiresPolling(void)
+{
+  for (auto & n : mROS2Nodes) {
+    if (n->RequiresPolling()) {
+      return true;
+    }
+  }
+  // the component manager services and the loaded components are
+  // spun by the executor
+  if (mInternals->mComponentManager
+      && ((mInternals->mComponentManager->GetNumberOfComponents() != 0)
+          || vtkMRMLROS2NodeInternals::HasForegroundEntities(mInternals->mComponentManager->get_node_base_interface()))) {
+    return true;
+  }
+  return false;
+}
+
+
+int vtkSlicerROS2Logic::GetWakeupFileDescriptor(void) const
+{
+  return vtkMRMLROS2::GetWakeupFileDescriptor();
 }
 
 
@@ -27,6 +27,7 @@
 // foward declarations
 // VTK
 class vtkTimerLog;
+class vtkMRMLROS2TimeStatistics;
 
 // Slicer
 class vtkMRMLROS2NodeNode;
@@ -35,12 +36,15 @@ class vtkMRMLROS2PublisherNode;
 class vtkMRMLROS2ParameterNode;
 class vtkMRMLROS2Tf2BroadcasterNode;
 class vtkMRMLROS2RobotNode;
+class vtkSlicerROS2LogicInternals;
 
 // Slicer includes
 #include <vtkSlicerModuleLogic.h>
 #include <vtkSmartPointer.h>
 #include <vtkSlicerROS2ModuleLogicExport.h>
 
+#include <memory>
+
 /// \ingroup Slicer_QtModules_ExtensionTemplate
 class VTK_SLICER_ROS2_MODULE_LOGIC_EXPORT vtkSlicerROS2Logic:
   public vtkSlicerModuleLogic
@@ -67,9 +71,83 @@ class VTK_SLICER_ROS2_MODULE_LOGIC_EXPORT vtkSlicerROS2Logic:
     incomming messages (subscriptions, parameters and tf2 lookups.  By
     default, this method is called using a Qt timer that will run as
     soon as this modules logic widget is displayed.  The default
-    frequency is 50Hz. */
+    frequency is 50Hz.  All the ROS nodes share a single executor
+    owned by the logic, so the cost of each spin doesn't depend on
+    the number of ROS nodes. */
   void Spin(void);
 
+  /*! Time spent in each call to Spin.  Each ROS node also provides
+    its own statistics (see vtkMRMLROS2NodeNode::GetSpinStatistics),
+    as well as subscribers, parameters... */
+  vtkMRMLROS2TimeStatistics * GetSpinStatistics(void);
+
+  /*! Time budget (in milliseconds) for each call to Spin, 0 means no
+    limit (default).  When a budget is set, the tf2 lookups (including
+    robot links) and parameters are updated first, then the messages
+    received in background and finally the ROS callbacks executed by
+    the shared executor (spin_some with a maximum duration).  Work not
+    done within the budget is left for the next Spin.  Even if the
+    budget is exceeded, each Spin updates at least one background
+    subscriber per ROS node and executes one ready ROS callback. */
+  void SetSpinBudget(const double & milliseconds);
+  inline double GetSpinBudget(void) const {
+    return mSpinBudget;
+  }
+
+  /*! Number of calls to Spin and number of times the spin budget was
+    exceeded, i.e. some work was left for the next Spin. */
+  inline size_t GetNumberOfSpins(void) const {
+    return mNumberOfSpins;
+  }
+  inline size_t GetNumberOfSpinBudgetOverruns(void) const {
+    return mNumberOfSpinBudgetOverruns;
+  }
+  void ResetSpinCounters(void);
+
+  /*! Record the spin loop (subscriber callbacks, conversions, tf2
+    lookups, MRML Modified events...) in a trace file using the
+    Chrome trace event format.  The file is written when StopTrace is
+    called and can be opened with https://ui.perfetto.dev.  At most
+    maximumNumberOfEvents events are kept, the following ones are
+    dropped and StopTrace issues a warning (see
+    GetNumberOfDroppedTraceEvents). */
+  bool StartTrace(const std::string & fileName, const int & maximumNumberOfEvents = 100000);
+  bool StopTrace(void);
+  bool IsTracing(void) const;
+  int GetNumberOfDroppedTraceEvents(void) const;
+
+  /*! Add begin/end events to the trace, e.g. from observers on the
+    render windows to see the rendering along the ROS events. */
+  void TraceBegin(const std::string & category, const std::string & name);
+  void TraceEnd(const std::string & category, const std::string & name);
+
+  /*! Maximum rate (in Hz) used to spin the ROS nodes, this is used to
+    cap the number of MRML updates (and renderings) triggered by ROS
+    messages.  Default is 50Hz. */
+  void SetMaximumSpinRate(const double & rate);
+  inline double GetMaximumSpinRate(void) const {
+    return mMaximumSpinRate;
+  }
+
+  /*! Rate (in Hz) used to spin the ROS nodes when none of them
+    requires polling (see RequiresPolling).  Default is 2Hz. */
+  void SetIdleSpinRate(const double & rate);
+  inline double GetIdleSpinRate(void) const {
+    return mIdleSpinRate;
+  }
+
+  /*! Returns true if any ROS node needs to be spun periodically at
+    the maximum spin rate, i.e. the executor has callbacks (including
+    services, timers and clients) outside the background callback
+    groups.  Otherwise the application can wait for the wakeup file
+    descriptor (see GetWakeupFileDescriptor). */
+  bool RequiresPolling(void);
+
+  /*! File descriptor that becomes readable when ROS messages received
+    in background are waiting to be moved to MRML.  Returns -1 if not
+    supported on this platform. */
+  int GetWakeupFileDescriptor(void) const;
+
   /*! Get the default ROS node attached to the core logic.  The
     default ROS node can be used for most applications.  It is started
     without any namespace.  If your application requires a ROS
@@ -82,6 +160,25 @@ class VTK_SLICER_ROS2_MODULE_LOGIC_EXPORT vtkSlicerROS2Logic:
   void AddRobot(const std::string & robotName, const std::string & parameterNodeName, const std::string & parameterName);
   void RemoveRobot(const std::string & robotName);
 
+  /*! Load a composable node (rclcpp_components) from a shared library
+    in Slicer's process, e.g. a camera driver.  The component is spun
+    by the logic's executor.  If intraProcess is set, messages
+    exchanged with ROS nodes created in Slicer with intra-process
+    communications are passed by pointer, see
+    vtkMRMLROS2NodeNode::Create.  Returns the component unique id or
+    0 if the component couldn't be loaded.  The component container
+    is created by the first call and removed, along with its
+    services, when its last component is unloaded. */
+  int LoadComponent(const std::string & packageName, const std::string & pluginName,
+                    const std::string & nodeName = "", const std::string & nodeNamespace = "",
+                    const bool & intraProcess = true);
+  bool UnloadComponent(const int & componentId);
+
+  /*! Number of components currently loaded, including the ones loaded
+    from the command line.  Loaded components require polling (see
+    RequiresPolling). */
+  int GetNumberOfComponents(void) const;
+
   vtkSmartPointer<vtkMRMLROS2NodeNode> mDefaultROS2Node; // should this be private?? UI needs to access it
 
  private:
@@ -90,8 +187,22 @@ class VTK_SLICER_ROS2_MODULE_LOGIC_EXPORT vtkSlicerROS2Logic:
   void operator=(const vtkSlicerROS2Logic&); // Not implemented
 
 
+  /*! Add newly created ROS nodes to the shared executor and remove
+    the ones that have been re-created or destroyed. */
+  void UpdateExecutorNodes(void);
+
+  /*! Remove the component container once it has no component. */
+  void ReleaseComponentManagerIfUnused(void);
+
   std::vector<vtkSmartPointer<vtkMRMLROS2NodeNode> > mROS2Nodes;
   vtkSmartPointer<vtkTimerLog> mTimerLog;
+  vtkSmartPointer<vtkMRMLROS2TimeStatistics> mSpinStatistics;
+  double mSpinBudget = 0.0;
+  size_t mNumberOfSpins = 0;
+  size_t mNumberOfSpinBudgetOverruns = 0;
+  double mMaximumSpinRate = 50.0;
+  double mIdleSpinRate = 2.0;
+  std::unique_ptr<vtkSlicerROS2LogicInternals> mInternals;
 };
 
 #endif
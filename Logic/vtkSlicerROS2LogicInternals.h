@@ -0,0 +1,108 @@
+#ifndef __vtkSlicerROS2LogicInternals_h
+#define __vtkSlicerROS2LogicInternals_h
+
+#include <map>
+
+#include <rclcpp/rclcpp.hpp>
+#include <rclcpp_components/component_manager.hpp>
+
+class vtkMRMLROS2NodeNode;
+
+/*! Component container running in Slicer's process.  The loaded
+  components are added to the logic's executor.  This also provides
+  the usual container services so components can be loaded using
+  "ros2 component load". */
+class vtkSlicerROS2ComponentManager: public rclcpp_components::ComponentManager
+{
+ public:
+  typedef rclcpp_components::ComponentManager BaseType;
+  using BaseType::BaseType;
+
+  /*! Load a component, returns its unique id or 0 if the component
+    can't be loaded. */
+  uint64_t Load(const std::string & packageName, const std::string & pluginName,
+                const std::string & nodeName, const std::string & nodeNamespace,
+                const bool & intraProcess, std::string & errorMessage)
+  {
+    auto request = std::make_shared<LoadNode::Request>();
+    request->package_name = packageName;
+    request->plugin_name = pluginName;
+    request->node_name = nodeName;
+    request->node_namespace = nodeNamespace;
+    rcl_interfaces::msg::Parameter intraProcessArgument;
+    intraProcessArgument.name = "use_intra_process_comms";
+    intraProcessArgument.value.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+    intraProcessArgument.value.bool_value = intraProcess;
+    request->extra_arguments.push_back(intraProcessArgument);
+    auto response = std::make_shared<LoadNode::Response>();
+    this->on_load_node(std::make_shared<rmw_request_id_t>(), request, response);
+    if (!response->success) {
+      errorMessage = response->error_message;
+      return 0;
+    }
+    return response->unique_id;
+  }
+
+  /*! Number of components currently loaded, including the ones
+    loaded using the container services. */
+  inline size_t GetNumberOfComponents(void) const {
+    return mNumberOfComponents;
+  }
+
+  bool Unload(const uint64_t & uniqueId, std::string & errorMessage)
+  {
+    auto request = std::make_shared<UnloadNode::Request>();
+    request->unique_id = uniqueId;
+    auto response = std::make_shared<UnloadNode::Response>();
+    this->on_unload_node(std::make_shared<rmw_request_id_t>(), request, response);
+    if (!response->success) {
+      errorMessage = response->error_message;
+    }
+    return response->success;
+  }
+
+ protected:
+  // also called by the container services
+  void on_load_node(const std::shared_ptr<rmw_request_id_t> requestHeader,
+                    const std::shared_ptr<LoadNode::Request> request,
+                    std::shared_ptr<LoadNode::Response> response) override
+  {
+    BaseType::on_load_node(requestHeader, request, response);
+    if (response->success) {
+      mNumberOfComponents++;
+    }
+  }
+
+  void on_unload_node(const std::shared_ptr<rmw_request_id_t> requestHeader,
+                      const std::shared_ptr<UnloadNode::Request> request,
+                      std::shared_ptr<UnloadNode::Response> response) override
+  {
+    BaseType::on_unload_node(requestHeader, request, response);
+    if (response->success && (mNumberOfComponents > 0)) {
+      mNumberOfComponents--;
+    }
+  }
+
+  size_t mNumberOfComponents = 0;
+};
+
+class vtkSlicerROS2LogicInternals
+{
+ public:
+  /*! Single executor shared by all the ROS nodes in the scene.  The
+    executor is created once, nodes are added/removed when the MRML
+    nodes are added/removed from the scene. */
+  std::shared_ptr<rclcpp::executors::StaticSingleThreadedExecutor> mExecutor
+    = std::make_shared<rclcpp::executors::StaticSingleThreadedExecutor>();
+
+  /*! ROS nodes currently added to the executor.  We keep the rclcpp
+    node used so we can remove it from the executor even if the MRML
+    node re-created its ROS node. */
+  std::map<vtkMRMLROS2NodeNode *, std::shared_ptr<rclcpp::Node> > mNodesInExecutor;
+
+  /*! Created on first use, the component manager and its components
+    are spun by the shared executor. */
+  std::shared_ptr<vtkSlicerROS2ComponentManager> mComponentManager;
+};
+
+#endif // __vtkSlicerROS2LogicInternals_h
@@ -0,0 +1,685 @@
+#include <vtkMRMLROS2GenericMessage.h>
+
+#include <cstdlib>
+#include <functional>
+#include <sstream>
+
+// ROS2
+#include <rclcpp/typesupport_helpers.hpp>
+#include <rcpputils/shared_library.hpp>
+#include <rmw/rmw.h>
+#include <rmw/error_handling.h>
+#include <rosidl_typesupport_introspection_cpp/field_types.hpp>
+#include <rosidl_typesupport_introspection_cpp/message_introspection.hpp>
+
+// VTK
+#include <vtkDoubleArray.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkStringArray.h>
+#include <vtkTable.h>
+
+namespace {
+
+  using namespace rosidl_typesupport_introspection_cpp;
+
+  typedef std::function<void(const std::string & path, const uint8_t & type, const void * value)> LeafVisitor;
+
+  inline const MessageMembers * GetMembers(const rosidl_message_type_support_t * typeSupport)
+  {
+    return static_cast<const MessageMembers *>(typeSupport->data);
+  }
+
+  inline const void * GetFieldPointer(const MessageMember & member, const void * data)
+  {
+    return static_cast<const uint8_t *>(data) + member.offset_;
+  }
+
+  // std::vector<bool> doesn't provide pointers on its elements
+  inline bool IsBoolVector(const MessageMember & member)
+  {
+    return member.is_array_
+      && (member.type_id_ == ROS_TYPE_BOOLEAN)
+      && (member.array_size_ == 0);
+  }
+
+  // number of elements, 1 for non arrays
+  size_t GetSize(const MessageMember & member, const void * field)
+  {
+    if (!member.is_array_) {
+      return 1;
+    }
+    if (IsBoolVector(member)) {
+      return static_cast<const std::vector<bool> *>(field)->size();
+    }
+    if (member.size_function) {
+      return member.size_function(field);
+    }
+    return member.array_size_;
+  }
+
+  // pointer on the nth element, bool vectors use the storage provided
+  const void * GetElement(const MessageMember & member, const void * field,
+                          const size_t & index, bool & boolStorage)
+  {
+    if (!member.is_array_) {
+      return field;
+    }
+    if (IsBoolVector(member)) {
+      boolStorage = (*static_cast<const std::vector<bool> *>(field))[index];
+      return &boolStorage;
+    }
+    if (member.get_const_function) {
+      return member.get_const_function(field, index);
+    }
+    return nullptr;
+  }
+
+  bool IsString(const uint8_t & type)
+  {
+    return (type == ROS_TYPE_STRING) || (type == ROS_TYPE_WSTRING);
+  }
+
+  bool ToDouble(const uint8_t & type, const void * value, double & result)
+  {
+    switch (type) {
+    case ROS_TYPE_FLOAT:
+      result = *static_cast<const float *>(value);
+      return true;
+    case ROS_TYPE_DOUBLE:
+      result = *static_cast<const double *>(value);
+      return true;
+    case ROS_TYPE_LONG_DOUBLE:
+      result = static_cast<double>(*static_cast<const long double *>(value));
+      return true;
+    case ROS_TYPE_CHAR:
+    case ROS_TYPE_OCTET:
+    case ROS_TYPE_UINT8:
+      result = *static_cast<const uint8_t *>(value);
+      return true;
+    case ROS_TYPE_WCHAR:
+      result = *static_cast<const char16_t *>(value);
+      return true;
+    case ROS_TYPE_BOOLEAN:
+      result = *static_cast<const bool *>(value) ? 1.0 : 0.0;
+      return true;
+    case ROS_TYPE_INT8:
+      result = *static_cast<const int8_t *>(value);
+      return true;
+    case ROS_TYPE_UINT16:
+      result = *static_cast<const uint16_t *>(value);
+      return true;
+    case ROS_TYPE_INT16:
+      result = *static_cast<const int16_t *>(value);
+      return true;
+    case ROS_TYPE_UINT32:
+      result = *static_cast<const uint32_t *>(value);
+      return true;
+    case ROS_TYPE_INT32:
+      result = *static_cast<const int32_t *>(value);
+      return true;
+    case ROS_TYPE_UINT64:
+      result = static_cast<double>(*static_cast<const uint64_t *>(value));
+      return true;
+    case ROS_TYPE_INT64:
+      result = static_cast<double>(*static_cast<const int64_t *>(value));
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  std::string ToString(const uint8_t & type, const void * value)
+  {
+    if (type == ROS_TYPE_STRING) {
+      return *static_cast<const std::string *>(value);
+    }
+    if (type == ROS_TYPE_WSTRING) {
+      // only keep ASCII characters
+      const std::u16string & wide = *static_cast<const std::u16string *>(value);
+      std::string result;
+      for (const auto & character : wide) {
+        result.push_back(character < 128 ? static_cast<char>(character) : '?');
+      }
+      return result;
+    }
+    std::stringstream out;
+    switch (type) {
+    case ROS_TYPE_BOOLEAN:
+      out << (*static_cast<const bool *>(value) ? "true" : "false");
+      break;
+    case ROS_TYPE_UINT64:
+      out << *static_cast<const uint64_t *>(value);
+      break;
+    case ROS_TYPE_INT64:
+      out << *static_cast<const int64_t *>(value);
+      break;
+    default:
+      double number;
+      if (ToDouble(type, value, number)) {
+        out.precision(17);
+        out << number;
+      }
+    }
+    return out.str();
+  }
+
+  vtkVariant ToVariant(const uint8_t & type, const void * value)
+  {
+    switch (type) {
+    case ROS_TYPE_STRING:
+    case ROS_TYPE_WSTRING:
+      return vtkVariant(vtkStdString(ToString(type, value)));
+    case ROS_TYPE_FLOAT:
+    case ROS_TYPE_DOUBLE:
+    case ROS_TYPE_LONG_DOUBLE:
+      {
+        double number = 0.0;
+        ToDouble(type, value, number);
+        return vtkVariant(number);
+      }
+    case ROS_TYPE_UINT64:
+      return vtkVariant(static_cast<unsigned long long>(*static_cast<const uint64_t *>(value)));
+    case ROS_TYPE_INT64:
+      return vtkVariant(static_cast<long long>(*static_cast<const int64_t *>(value)));
+    default:
+      {
+        double number = 0.0;
+        ToDouble(type, value, number);
+        return vtkVariant(static_cast<long long>(number));
+      }
+    }
+  }
+
+  void VisitLeaves(const MessageMembers * members, const void * data,
+                   const std::string & prefix, const LeafVisitor & visitor)
+  {
+    bool boolStorage;
+    for (uint32_t index = 0; index < members->member_count_; ++index) {
+      const MessageMember & member = members->members_[index];
+      const void * field = GetFieldPointer(member, data);
+      const std::string path = prefix + member.name_;
+      const size_t size = GetSize(member, field);
+      for (size_t elementIndex = 0; elementIndex < size; ++elementIndex) {
+        const void * element = GetElement(member, field, elementIndex, boolStorage);
+        if (element == nullptr) {
+          continue;
+        }
+        const std::string elementPath
+          = member.is_array_ ? path + "[" + std::to_string(elementIndex) + "]" : path;
+        if (member.type_id_ == ROS_TYPE_MESSAGE) {
+          VisitLeaves(GetMembers(member.members_), element, elementPath + ".", visitor);
+        } else {
+          visitor(elementPath, member.type_id_, element);
+        }
+      }
+    }
+  }
+
+  /* One column per field with a value, sequences and arrays of
+     numbers or strings are stored in a single column with one
+     component per element.  Messages (including arrays of messages)
+     are flattened using the field paths. */
+  void AddColumns(const MessageMembers * members, const void * data,
+                  const std::string & prefix, vtkTable * result)
+  {
+    bool boolStorage;
+    for (uint32_t index = 0; index < members->member_count_; ++index) {
+      const MessageMember & member = members->members_[index];
+      const void * field = GetFieldPointer(member, data);
+      const std::string path = prefix + member.name_;
+      const size_t size = GetSize(member, field);
+      if (member.type_id_ == ROS_TYPE_MESSAGE) {
+        for (size_t elementIndex = 0; elementIndex < size; ++elementIndex) {
+          const void * element = GetElement(member, field, elementIndex, boolStorage);
+          if (element != nullptr) {
+            const std::string elementPath
+              = member.is_array_ ? path + "[" + std::to_string(elementIndex) + "]" : path;
+            AddColumns(GetMembers(member.members_), element, elementPath + ".", result);
+          }
+        }
+        continue;
+      }
+      // empty sequences, a column needs at least one component
+      if (size == 0) {
+        continue;
+      }
+      if (IsString(member.type_id_)) {
+        vtkNew<vtkStringArray> column;
+        column->SetName(path.c_str());
+        column->SetNumberOfComponents(static_cast<int>(size));
+        column->SetNumberOfTuples(1);
+        for (size_t elementIndex = 0; elementIndex < size; ++elementIndex) {
+          const void * element = GetElement(member, field, elementIndex, boolStorage);
+          column->SetValue(elementIndex, element ? ToString(member.type_id_, element) : "");
+        }
+        result->AddColumn(column);
+      } else {
+        vtkNew<vtkDoubleArray> column;
+        column->SetName(path.c_str());
+        column->SetNumberOfComponents(static_cast<int>(size));
+        column->SetNumberOfTuples(1);
+        for (size_t elementIndex = 0; elementIndex < size; ++elementIndex) {
+          const void * element = GetElement(member, field, elementIndex, boolStorage);
+          double number = vtkMath::Nan();
+          if (element != nullptr) {
+            ToDouble(member.type_id_, element, number);
+          }
+          column->SetValue(elementIndex, number);
+        }
+        result->AddColumn(column);
+      }
+    }
+  }
+
+  void WriteYAML(const MessageMembers * members, const void * data,
+                 const std::string & indent, std::ostream & out)
+  {
+    bool boolStorage;
+    for (uint32_t index = 0; index < members->member_count_; ++index) {
+      const MessageMember & member = members->members_[index];
+      const void * field = GetFieldPointer(member, data);
+      out << indent << member.name_ << ":";
+      if (!member.is_array_) {
+        if (member.type_id_ == ROS_TYPE_MESSAGE) {
+          out << "\n";
+          WriteYAML(GetMembers(member.members_), field, indent + "  ", out);
+        } else if (IsString(member.type_id_)) {
+          out << " \"" << ToString(member.type_id_, field) << "\"\n";
+        } else {
+          out << " " << ToString(member.type_id_, field) << "\n";
+        }
+        continue;
+      }
+      const size_t size = GetSize(member, field);
+      if (size == 0) {
+        out << " []\n";
+        continue;
+      }
+      out << "\n";
+      for (size_t elementIndex = 0; elementIndex < size; ++elementIndex) {
+        const void * element = GetElement(member, field, elementIndex, boolStorage);
+        if (element == nullptr) {
+          continue;
+        }
+        if (member.type_id_ == ROS_TYPE_MESSAGE) {
+          out << indent << "-\n";
+          WriteYAML(GetMembers(member.members_), element, indent + "  ", out);
+        } else if (IsString(member.type_id_)) {
+          out << indent << "- \"" << ToString(member.type_id_, element) << "\"\n";
+        } else {
+          out << indent << "- " << ToString(member.type_id_, element) << "\n";
+        }
+      }
+    }
+  }
+
+  // split "name[index]", index is set to -1 if there is no index
+  bool ParsePathElement(const std::string & element, std::string & name, long & index)
+  {
+    const size_t bracket = element.find('[');
+    if (bracket == std::string::npos) {
+      name = element;
+      index = -1;
+      return !name.empty();
+    }
+    if (element.back() != ']') {
+      return false;
+    }
+    name = element.substr(0, bracket);
+    const std::string indexString = element.substr(bracket + 1, element.size() - bracket - 2);
+    char * end = nullptr;
+    index = std::strtol(indexString.c_str(), &end, 10);
+    return !name.empty() && !indexString.empty() && (*end == '\0') && (index >= 0);
+  }
+
+  // location of a leaf field, bool vectors don't provide pointers on their elements
+  struct FieldLocation {
+    uint8_t Type = 0;
+    void * Value = nullptr;
+    std::vector<bool> * BoolVector = nullptr;
+    size_t BoolIndex = 0;
+  };
+
+  /* Find a leaf field given its path.  If resize is true, sequences
+     are extended so the index is valid (used to set fields). */
+  bool FindField(const MessageMembers * members, void * data, const std::string & path,
+                 const bool & resize, FieldLocation & location, std::string & errorMessage)
+  {
+    void * current = data;
+    std::stringstream pathStream(path);
+    std::string pathElement;
+    while (std::getline(pathStream, pathElement, '.')) {
+      std::string name;
+      long index;
+      if (!ParsePathElement(pathElement, name, index)) {
+        errorMessage = "invalid field \"" + pathElement + "\" in \"" + path + "\"";
+        return false;
+      }
+      if (members == nullptr) {
+        errorMessage = "\"" + name + "\" in \"" + path + "\" is not a field of a message";
+        return false;
+      }
+      const MessageMember * member = nullptr;
+      for (uint32_t memberIndex = 0; memberIndex < members->member_count_; ++memberIndex) {
+        if (name == members->members_[memberIndex].name_) {
+          member = &(members->members_[memberIndex]);
+          break;
+        }
+      }
+      if (member == nullptr) {
+        errorMessage = "no field \"" + name + "\" in \"" + path + "\"";
+        return false;
+      }
+      void * field = static_cast<uint8_t *>(current) + member->offset_;
+      if (!member->is_array_) {
+        if (index >= 0) {
+          errorMessage = "field \"" + name + "\" in \"" + path + "\" is not an array";
+          return false;
+        }
+        current = field;
+      } else {
+        if (index < 0) {
+          errorMessage = "field \"" + name + "\" in \"" + path + "\" is an array and requires an index";
+          return false;
+        }
+        const size_t elementIndex = index;
+        const bool isSequence = (member->array_size_ == 0) || member->is_upper_bound_;
+        if (elementIndex >= GetSize(*member, field)) {
+          if (!resize || !isSequence
+              || (member->is_upper_bound_ && (elementIndex >= member->array_size_))) {
+            errorMessage = "index out of range for field \"" + name + "\" in \"" + path + "\"";
+            return false;
+          }
+          if (IsBoolVector(*member)) {
+            static_cast<std::vector<bool> *>(field)->resize(elementIndex + 1);
+          } else if (member->resize_function) {
+            member->resize_function(field, elementIndex + 1);
+          } else {
+            errorMessage = "field \"" + name + "\" in \"" + path + "\" can't be resized";
+            return false;
+          }
+        }
+        if (IsBoolVector(*member)) {
+          // bool vectors can only contain leaves
+          location.BoolVector = static_cast<std::vector<bool> *>(field);
+          location.BoolIndex = elementIndex;
+          location.Type = ROS_TYPE_BOOLEAN;
+          if (pathStream.peek() != std::char_traits<char>::eof()) {
+            errorMessage = "\"" + name + "\" in \"" + path + "\" is not a message";
+            return false;
+          }
+          return true;
+        }
+        current = member->get_function ? member->get_function(field, elementIndex) : nullptr;
+        if (current == nullptr) {
+          errorMessage = "elements of field \"" + name + "\" in \"" + path + "\" can't be accessed";
+          return false;
+        }
+      }
+      if (member->type_id_ == ROS_TYPE_MESSAGE) {
+        members = GetMembers(member->members_);
+      } else {
+        members = nullptr;
+        location.Type = member->type_id_;
+        location.Value = current;
+      }
+    }
+    if (members != nullptr) {
+      errorMessage = "\"" + path + "\" is not a field with a value (number or string)";
+      return false;
+    }
+    return true;
+  }
+
+  bool FromVariant(const uint8_t & type, const vtkVariant & value, void * target)
+  {
+    bool valid = false;
+    switch (type) {
+    case ROS_TYPE_STRING:
+      *static_cast<std::string *>(target) = value.ToString();
+      return true;
+    case ROS_TYPE_WSTRING:
+      {
+        const std::string narrow = value.ToString();
+        *static_cast<std::u16string *>(target) = std::u16string(narrow.begin(), narrow.end());
+        return true;
+      }
+    case ROS_TYPE_BOOLEAN:
+      if (value.IsString()) {
+        const std::string text = value.ToString();
+        valid = (text == "true") || (text == "false") || (text == "1") || (text == "0");
+        *static_cast<bool *>(target) = (text == "true") || (text == "1");
+      } else {
+        *static_cast<bool *>(target) = (value.ToDouble(&valid) != 0.0);
+      }
+      return valid;
+    case ROS_TYPE_FLOAT:
+      *static_cast<float *>(target) = value.ToFloat(&valid);
+      return valid;
+    case ROS_TYPE_DOUBLE:
+      *static_cast<double *>(target) = value.ToDouble(&valid);
+      return valid;
+    case ROS_TYPE_LONG_DOUBLE:
+      *static_cast<long double *>(target) = value.ToDouble(&valid);
+      return valid;
+    case ROS_TYPE_CHAR:
+    case ROS_TYPE_OCTET:
+    case ROS_TYPE_UINT8:
+      *static_cast<uint8_t *>(target) = static_cast<uint8_t>(value.ToUnsignedLongLong(&valid));
+      return valid;
+    case ROS_TYPE_WCHAR:
+      *static_cast<char16_t *>(target) = static_cast<char16_t>(value.ToUnsignedLongLong(&valid));
+      return valid;
+    case ROS_TYPE_INT8:
+      *static_cast<int8_t *>(target) = static_cast<int8_t>(value.ToLongLong(&valid));
+      return valid;
+    case ROS_TYPE_UINT16:
+      *static_cast<uint16_t *>(target) = static_cast<uint16_t>(value.ToUnsignedLongLong(&valid));
+      return valid;
+    case ROS_TYPE_INT16:
+      *static_cast<int16_t *>(target) = static_cast<int16_t>(value.ToLongLong(&valid));
+      return valid;
+    case ROS_TYPE_UINT32:
+      *static_cast<uint32_t *>(target) = static_cast<uint32_t>(value.ToUnsignedLongLong(&valid));
+      return valid;
+    case ROS_TYPE_INT32:
+      *static_cast<int32_t *>(target) = static_cast<int32_t>(value.ToLongLong(&valid));
+      return valid;
+    case ROS_TYPE_UINT64:
+      *static_cast<uint64_t *>(target) = value.ToUnsignedLongLong(&valid);
+      return valid;
+    case ROS_TYPE_INT64:
+      *static_cast<int64_t *>(target) = value.ToLongLong(&valid);
+      return valid;
+    default:
+      return false;
+    }
+  }
+
+}
+
+
+std::shared_ptr<const vtkMRMLROS2GenericMessageType>
+vtkMRMLROS2GenericMessageType::Create(const std::string & type, std::string & errorMessage)
+{
+  std::shared_ptr<vtkMRMLROS2GenericMessageType> result(new vtkMRMLROS2GenericMessageType);
+  result->mName = type;
+  try {
+    result->mTypeSupportLibrary = rclcpp::get_typesupport_library(type, "rosidl_typesupport_cpp");
+    result->mTypeSupport = rclcpp::get_typesupport_handle(type, "rosidl_typesupport_cpp",
+                                                          *(result->mTypeSupportLibrary));
+    result->mIntrospectionLibrary = rclcpp::get_typesupport_library(type, "rosidl_typesupport_introspection_cpp");
+    result->mIntrospection = rclcpp::get_typesupport_handle(type, "rosidl_typesupport_introspection_cpp",
+                                                            *(result->mIntrospectionLibrary));
+  } catch (const std::exception & exception) {
+    errorMessage = "unable to load type support for \"" + type + "\": " + exception.what();
+    return nullptr;
+  }
+  return result;
+}
+
+
+std::shared_ptr<void> vtkMRMLROS2GenericMessageType::CreateMessage(std::string & errorMessage) const
+{
+  const MessageMembers * members = GetMembers(mIntrospection);
+  void * data = std::malloc(members->size_of_);
+  if (data == nullptr) {
+    errorMessage = "unable to allocate message of type \"" + mName + "\"";
+    return nullptr;
+  }
+  members->init_function(data, rosidl_runtime_cpp::MessageInitialization::ALL);
+  // the deleter keeps the type support loaded as long as the message exists
+  std::shared_ptr<const vtkMRMLROS2GenericMessageType> self = shared_from_this();
+  return std::shared_ptr<void>(data, [self, members](void * message) {
+                                       members->fini_function(message);
+                                       std::free(message);
+                                     });
+}
+
+
+std::shared_ptr<const void>
+vtkMRMLROS2GenericMessageType::Deserialize(const rclcpp::SerializedMessage & serialized,
+                                           std::string & errorMessage) const
+{
+  std::shared_ptr<void> result = CreateMessage(errorMessage);
+  if (!result) {
+    return nullptr;
+  }
+  if (rmw_deserialize(&(serialized.get_rcl_serialized_message()), mTypeSupport, result.get()) != RMW_RET_OK) {
+    errorMessage = "unable to deserialize message of type \"" + mName + "\": " + rmw_get_error_string().str;
+    rmw_reset_error();
+    return nullptr;
+  }
+  return result;
+}
+
+
+bool vtkMRMLROS2GenericMessageType::Serialize(const void * data, rclcpp::SerializedMessage & result,
+                                              std::string & errorMessage) const
+{
+  // the serialized message buffer is reused, rmw only grows it if needed
+  if (rmw_serialize(data, mTypeSupport, &(result.get_rcl_serialized_message())) != RMW_RET_OK) {
+    errorMessage = "unable to serialize message of type \"" + mName + "\": " + rmw_get_error_string().str;
+    rmw_reset_error();
+    return false;
+  }
+  return true;
+}
+
+
+void vtkMRMLROS2GenericMessageType::ToYAML(const void * data, std::ostream & out) const
+{
+  WriteYAML(GetMembers(mIntrospection), data, "", out);
+}
+
+
+bool vtkMRMLROS2GenericMessageType::ToValues(const void * data, std::vector<double> & result) const
+{
+  result.clear();
+  VisitLeaves(GetMembers(mIntrospection), data, "",
+              [&result](const std::string &, const uint8_t & type, const void * value) {
+                double number;
+                if (ToDouble(type, value, number)) {
+                  result.push_back(number);
+                }
+              });
+  return !result.empty();
+}
+
+
+void vtkMRMLROS2GenericMessageType::ToTable(const void * data, vtkTable * result) const
+{
+  result->Initialize();
+  AddColumns(GetMembers(mIntrospection), data, "", result);
+}
+
+
+bool vtkMRMLROS2GenericMessageType::GetField(const void * data, const std::string & path,
+                                             vtkVariant & result, std::string & errorMessage) const
+{
+  FieldLocation location;
+  if (!FindField(GetMembers(mIntrospection), const_cast<void *>(data), path, false, location, errorMessage)) {
+    return false;
+  }
+  if (location.BoolVector != nullptr) {
+    result = vtkVariant(static_cast<int>((*location.BoolVector)[location.BoolIndex]));
+  } else {
+    result = ToVariant(location.Type, location.Value);
+  }
+  return true;
+}
+
+
+bool vtkMRMLROS2GenericMessageType::SetField(void * data, const std::string & path,
+                                             const vtkVariant & value, std::string & errorMessage) const
+{
+  FieldLocation location;
+  if (!FindField(GetMembers(mIntrospection), data, path, true, location, errorMessage)) {
+    return false;
+  }
+  if (location.BoolVector != nullptr) {
+    bool boolValue;
+    if (!FromVariant(ROS_TYPE_BOOLEAN, value, &boolValue)) {
+      errorMessage = "unable to convert \"" + value.ToString() + "\" to a boolean for field \"" + path + "\"";
+      return false;
+    }
+    (*location.BoolVector)[location.BoolIndex] = boolValue;
+    return true;
+  }
+  if (!FromVariant(location.Type, value, location.Value)) {
+    errorMessage = "unable to convert \"" + value.ToString() + "\" to the type of field \"" + path + "\"";
+    return false;
+  }
+  return true;
+}
+
+
+const void * vtkMRMLROS2GenericMessage::GetData(std::string & errorMessage) const
+{
+  std::call_once(mDeserialized, [this]() {
+                                  if (!mType || !mSerialized) {
+                                    mErrorMessage = "no message received yet";
+                                    return;
+                                  }
+                                  mData = mType->Deserialize(*mSerialized, mErrorMessage);
+                                });
+  if (!mData) {
+    errorMessage = mErrorMessage;
+  }
+  return mData.get();
+}
+
+
+void vtkMRMLROS2ToYAML(const vtkMRMLROS2GenericMessage & input, std::ostream & out)
+{
+  // errors are reported by the subscriber, see vtkMRMLROS2GenericSubscriberInternals
+  std::string errorMessage;
+  const void * data = input.GetData(errorMessage);
+  if (data != nullptr) {
+    input.GetType()->ToYAML(data, out);
+  }
+}
+
+
+bool vtkROS2ToSlicerValues(const vtkMRMLROS2GenericMessage & input, std::vector<double> & result)
+{
+  std::string errorMessage;
+  const void * data = input.GetData(errorMessage);
+  if (data == nullptr) {
+    return false;
+  }
+  return input.GetType()->ToValues(data, result);
+}
+
+
+void vtkROS2ToSlicer(const vtkMRMLROS2GenericMessage & input, vtkSmartPointer<vtkTable> result)
+{
+  std::string errorMessage;
+  const void * data = input.GetData(errorMessage);
+  if (data == nullptr) {
+    result->Initialize();
+    return;
+  }
+  input.GetType()->ToTable(data, result);
+}
@@ -0,0 +1,147 @@
+#ifndef __vtkMRMLROS2GenericMessage_h
+#define __vtkMRMLROS2GenericMessage_h
+
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// ROS2
+#include <rclcpp/serialized_message.hpp>
+#include <rosidl_runtime_cpp/traits.hpp>
+
+// VTK
+#include <vtkSmartPointer.h>
+#include <vtkVariant.h>
+
+class vtkTable;
+struct rosidl_message_type_support_t;
+namespace rcpputils {
+  class SharedLibrary;
+}
+
+/*! ROS message type loaded at runtime using its name
+  (e.g. "geometry_msgs/msg/PoseStamped").  The C++ type support is
+  used to deserialize messages and the introspection type support is
+  used to access the fields by name.  Fields are identified by paths
+  such as "pose.position.x" or "data[3]". */
+class vtkMRMLROS2GenericMessageType:
+  public std::enable_shared_from_this<vtkMRMLROS2GenericMessageType>
+{
+public:
+  /*! Load the type support libraries.  Returns nullptr and sets the
+    error message if the type can't be found. */
+  static std::shared_ptr<const vtkMRMLROS2GenericMessageType>
+    Create(const std::string & type, std::string & errorMessage);
+
+  inline const std::string & GetName(void) const {
+    return mName;
+  }
+
+  /*! Allocate and initialize a message of this type (all fields set
+    to their default values). */
+  std::shared_ptr<void> CreateMessage(std::string & errorMessage) const;
+
+  /*! Deserialize a message, returns nullptr and sets the error
+    message if the deserialization failed. */
+  std::shared_ptr<const void> Deserialize(const rclcpp::SerializedMessage & serialized,
+                                          std::string & errorMessage) const;
+
+  /*! Serialize a message created with this type.  The result is
+    reused, its buffer is only reallocated if it is too small. */
+  bool Serialize(const void * data, rclcpp::SerializedMessage & result,
+                 std::string & errorMessage) const;
+
+  /*! Methods below take a message created or deserialized with this
+    type. */
+  void ToYAML(const void * data, std::ostream & out) const;
+
+  /*! Numeric fields (including booleans) in order, strings are
+    skipped.  Returns false if there is no numeric field. */
+  bool ToValues(const void * data, std::vector<double> & result) const;
+
+  /*! One row with one column per field, the column name is the field
+    path.  Sequences and arrays of numbers or strings use a single
+    column with one component per element, empty sequences have no
+    column.  Numeric fields are stored as doubles. */
+  void ToTable(const void * data, vtkTable * result) const;
+
+  /*! Value of a field (number or string) given its path. */
+  bool GetField(const void * data, const std::string & path,
+                vtkVariant & result, std::string & errorMessage) const;
+
+  /*! Set the value of a field given its path.  Sequences are
+    extended if the index is past their current size.  Numbers and
+    strings are converted to the field type, returns false if the
+    conversion is not possible. */
+  bool SetField(void * data, const std::string & path,
+                const vtkVariant & value, std::string & errorMessage) const;
+
+protected:
+  vtkMRMLROS2GenericMessageType() = default;
+
+  std::string mName;
+  std::shared_ptr<rcpputils::SharedLibrary> mTypeSupportLibrary;
+  std::shared_ptr<rcpputils::SharedLibrary> mIntrospectionLibrary;
+  const rosidl_message_type_support_t * mTypeSupport = nullptr;
+  const rosidl_message_type_support_t * mIntrospection = nullptr;
+};
+
+
+/*! Message received by a generic subscriber.  The serialized message
+  is kept as is and deserialized only when a field is accessed. */
+class vtkMRMLROS2GenericMessage
+{
+public:
+  vtkMRMLROS2GenericMessage() = default;
+  vtkMRMLROS2GenericMessage(std::shared_ptr<const vtkMRMLROS2GenericMessageType> type,
+                            std::shared_ptr<const rclcpp::SerializedMessage> serialized):
+    mType(std::move(type)),
+    mSerialized(std::move(serialized))
+  {}
+  vtkMRMLROS2GenericMessage(const vtkMRMLROS2GenericMessage &) = delete;
+  vtkMRMLROS2GenericMessage & operator = (const vtkMRMLROS2GenericMessage &) = delete;
+
+  inline const std::shared_ptr<const vtkMRMLROS2GenericMessageType> & GetType(void) const {
+    return mType;
+  }
+
+  inline const std::shared_ptr<const rclcpp::SerializedMessage> & GetSerialized(void) const {
+    return mSerialized;
+  }
+
+  /*! Deserialized message, the deserialization is performed on the
+    first call only.  This is thread safe.  Returns nullptr and sets
+    the error message for an empty message or if the message can't be
+    deserialized. */
+  const void * GetData(std::string & errorMessage) const;
+
+  /*! True if this is not a received message, i.e. the subscriber
+    hasn't received any message yet. */
+  inline bool IsEmpty(void) const {
+    return !mSerialized;
+  }
+
+protected:
+  // declared first so the type support is unloaded last
+  std::shared_ptr<const vtkMRMLROS2GenericMessageType> mType;
+  std::shared_ptr<const rclcpp::SerializedMessage> mSerialized;
+  mutable std::once_flag mDeserialized;
+  mutable std::shared_ptr<const void> mData;
+  mutable std::string mErrorMessage;
+};
+
+// used by the subscriber internals, see vtkROS2ToSlicer.h
+void vtkMRMLROS2ToYAML(const vtkMRMLROS2GenericMessage & input, std::ostream & out);
+bool vtkROS2ToSlicerValues(const vtkMRMLROS2GenericMessage & input, std::vector<double> & result);
+void vtkROS2ToSlicer(const vtkMRMLROS2GenericMessage & input, vtkSmartPointer<vtkTable> result);
+
+namespace rosidl_generator_traits {
+  template <>
+  inline const char * name<vtkMRMLROS2GenericMessage>() {
+    return "generic";
+  }
+}
+
+#endif // __vtkMRMLROS2GenericMessage_h
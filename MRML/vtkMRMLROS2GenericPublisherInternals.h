@@ -0,0 +1,174 @@
+#ifndef __vtkMRMLROS2GenericPublisherInternals_h
+#define __vtkMRMLROS2GenericPublisherInternals_h
+
+#include <sstream>
+
+#include <vtkMRMLROS2GenericMessage.h>
+#include <vtkMRMLROS2PublisherInternals.h>
+
+/*! Internals for publishers using a message type only known at
+  runtime.  The message is allocated once, fields are set in place
+  and the same message and serialization buffer are reused for each
+  call to Publish. */
+class vtkMRMLROS2GenericPublisherInternals: public vtkMRMLROS2PublisherInternals
+{
+public:
+  vtkMRMLROS2GenericPublisherInternals(vtkMRMLROS2PublisherNode * mrmlNode):
+    vtkMRMLROS2PublisherInternals(mrmlNode)
+  {}
+
+  bool SetType(const std::string & type, std::string & errorMessage)
+  {
+    std::shared_ptr<const vtkMRMLROS2GenericMessageType> messageType
+      = vtkMRMLROS2GenericMessageType::Create(type, errorMessage);
+    if (!messageType) {
+      return false;
+    }
+    std::shared_ptr<void> message = messageType->CreateMessage(errorMessage);
+    if (!message) {
+      return false;
+    }
+    mType = messageType;
+    mMessage = message;
+    return true;
+  }
+
+  inline bool HasType(void) const {
+    return (mType != nullptr);
+  }
+
+  bool AddToROS2Node(vtkMRMLNode * nodeInScene, const char * nodeId,
+                     const std::string & topic, std::string & errorMessage) override
+  {
+    if (!mType) {
+      errorMessage = "the ROS type must be set (SetROSType) before the generic publisher for \"" + topic + "\" is added";
+      return false;
+    }
+    if (mMRMLNode->mAsynchronous) {
+      // the message is modified in place by SetField, it can't be queued
+      errorMessage = "asynchronous mode is not supported by the generic publisher for \"" + topic + "\"";
+      return false;
+    }
+    vtkMRMLROS2NodeNode * mrmlROSNodePtr = vtkMRMLROS2::CheckROS2NodeExists(nodeInScene, nodeId, errorMessage);
+    if (!mrmlROSNodePtr) return false;
+
+    vtkMRMLROS2PublisherNode * pub = mrmlROSNodePtr->GetPublisherNodeByTopic(topic);
+    if ((pub != nullptr)
+        && pub->IsAddedToROS2Node()) {
+      errorMessage = "there is already a publisher for topic \"" + topic + "\" added to the ROS node";
+      return false;
+    }
+    mROSNode = mrmlROSNodePtr->mInternals->mNodePointer;
+    // serialized messages can't use intra-process communications
+    rclcpp::PublisherOptions options;
+    options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+    mPublisher = mROSNode->create_generic_publisher(topic, mType->GetName(),
+                                                    vtkMRMLROS2::ToROS2QoS(mMRMLNode->mQoS), options);
+    mrmlROSNodePtr->SetNthNodeReferenceID("publisher",
+                                          mrmlROSNodePtr->GetNumberOfNodeReferences("publisher"),
+                                          mMRMLNode->GetID());
+    mMRMLNode->SetNodeReferenceID("node", nodeId);
+    mrmlROSNodePtr->WarnIfNotSpinning("adding publisher for \"" + topic + "\"");
+    return true;
+  }
+
+  bool RemoveFromROS2Node(vtkMRMLNode * nodeInScene, const char * nodeId,
+                          const std::string & topic, std::string & errorMessage) override
+  {
+    vtkMRMLROS2NodeNode * rosNodePtr = vtkMRMLROS2::CheckROS2NodeExists(nodeInScene, nodeId, errorMessage);
+    if (!rosNodePtr) return false;
+
+    vtkMRMLROS2PublisherNode * pub = rosNodePtr->GetPublisherNodeByTopic(topic);
+    if (pub == nullptr || !pub->IsAddedToROS2Node()) {
+      errorMessage = "there isn't a publisher for topic \"" + topic + "\" which can be deleted from the ROS node";
+      return false;
+    }
+
+    mMRMLNode->SetNodeReferenceID("node", nullptr);
+    rosNodePtr->RemoveNthNodeReferenceID("publisher",
+                                         rosNodePtr->GetNumberOfNodeReferences("publisher"));
+
+    mPublisher.reset();
+    mROSNode.reset();
+
+    return true;
+  }
+
+  bool IsAddedToROS2Node(void) const override
+  {
+    return (mPublisher != nullptr);
+  }
+
+  const char * GetROSType(void) const override
+  {
+    return mType ? mType->GetName().c_str() : "undefined";
+  }
+
+  const char * GetSlicerType(void) const override
+  {
+    return typeid(vtkVariant).name();
+  }
+
+  bool SetField(const std::string & path, const vtkVariant & value, std::string & errorMessage)
+  {
+    if (!mType) {
+      errorMessage = "the ROS type must be set first (SetROSType)";
+      return false;
+    }
+    return mType->SetField(mMessage.get(), path, value, errorMessage);
+  }
+
+  bool GetField(const std::string & path, vtkVariant & result, std::string & errorMessage) const
+  {
+    if (!mType) {
+      errorMessage = "the ROS type must be set first (SetROSType)";
+      return false;
+    }
+    return mType->GetField(mMessage.get(), path, result, errorMessage);
+  }
+
+  std::string GetMessageYAML(void) const
+  {
+    std::stringstream out;
+    if (mType) {
+      mType->ToYAML(mMessage.get(), out);
+    }
+    return out.str();
+  }
+
+  bool ResetMessage(std::string & errorMessage)
+  {
+    if (!mType) {
+      errorMessage = "the ROS type must be set first (SetROSType)";
+      return false;
+    }
+    std::shared_ptr<void> message = mType->CreateMessage(errorMessage);
+    if (!message) {
+      return false;
+    }
+    mMessage = message;
+    return true;
+  }
+
+  bool Publish(size_t & numberOfSubscribers, std::string & errorMessage)
+  {
+    numberOfSubscribers = mPublisher->get_subscription_count();
+    if (numberOfSubscribers == 0) {
+      return true;
+    }
+    if (!mType->Serialize(mMessage.get(), mSerializedMessage, errorMessage)) {
+      numberOfSubscribers = 0;
+      return false;
+    }
+    mPublisher->publish(mSerializedMessage);
+    return true;
+  }
+
+protected:
+  std::shared_ptr<const vtkMRMLROS2GenericMessageType> mType;
+  std::shared_ptr<void> mMessage;
+  rclcpp::SerializedMessage mSerializedMessage;
+  std::shared_ptr<rclcpp::GenericPublisher> mPublisher = nullptr;
+};
+
+#endif // __vtkMRMLROS2GenericPublisherInternals_h
@@ -0,0 +1,134 @@
+#include <vtkMRMLROS2GenericPublisherNode.h>
+#include <vtkMRMLROS2GenericPublisherInternals.h>
+
+vtkStandardNewMacro(vtkMRMLROS2GenericPublisherNode);
+
+
+vtkMRMLROS2GenericPublisherNode::vtkMRMLROS2GenericPublisherNode()
+{
+  mInternals = new vtkMRMLROS2GenericPublisherInternals(this);
+}
+
+
+vtkMRMLROS2GenericPublisherNode::~vtkMRMLROS2GenericPublisherNode()
+{
+  delete mInternals;
+}
+
+
+vtkMRMLNode * vtkMRMLROS2GenericPublisherNode::CreateNodeInstance(void)
+{
+  return SelfType::New();
+}
+
+
+const char * vtkMRMLROS2GenericPublisherNode::GetNodeTagName(void)
+{
+  return "ROS2GenericPublisher";
+}
+
+
+bool vtkMRMLROS2GenericPublisherNode::SetROSType(const std::string & type)
+{
+  if (IsAddedToROS2Node()) {
+    vtkErrorMacro(<< "SetROSType: type must be set before the publisher for topic \"" << mTopic << "\" is added to the ROS node");
+    return false;
+  }
+  std::string errorMessage;
+  if (!(static_cast<vtkMRMLROS2GenericPublisherInternals *>(mInternals))->SetType(type, errorMessage)) {
+    vtkErrorMacro(<< "SetROSType: " << errorMessage);
+    return false;
+  }
+  return true;
+}
+
+
+bool vtkMRMLROS2GenericPublisherNode::SetField(const std::string & path, const vtkVariant & value)
+{
+  std::string errorMessage;
+  if (!(static_cast<vtkMRMLROS2GenericPublisherInternals *>(mInternals))->SetField(path, value, errorMessage)) {
+    vtkErrorMacro(<< "SetField: " << errorMessage);
+    return false;
+  }
+  return true;
+}
+
+
+bool vtkMRMLROS2GenericPublisherNode::SetField(const std::string & path, const double & value)
+{
+  return SetField(path, vtkVariant(value));
+}
+
+
+bool vtkMRMLROS2GenericPublisherNode::SetField(const std::string & path, const std::string & value)
+{
+  return SetField(path, vtkVariant(vtkStdString(value)));
+}
+
+
+vtkVariant vtkMRMLROS2GenericPublisherNode::GetField(const std::string & path)
+{
+  vtkVariant result;
+  std::string errorMessage;
+  if (!(static_cast<vtkMRMLROS2GenericPublisherInternals *>(mInternals))->GetField(path, result, errorMessage)) {
+    vtkErrorMacro(<< "GetField: " << errorMessage);
+    return vtkVariant();
+  }
+  return result;
+}
+
+
+std::string vtkMRMLROS2GenericPublisherNode::GetMessageYAML(void) const
+{
+  return (static_cast<vtkMRMLROS2GenericPublisherInternals *>(mInternals))->GetMessageYAML();
+}
+
+
+bool vtkMRMLROS2GenericPublisherNode::ResetMessage(void)
+{
+  std::string errorMessage;
+  if (!(static_cast<vtkMRMLROS2GenericPublisherInternals *>(mInternals))->ResetMessage(errorMessage)) {
+    vtkErrorMacro(<< "ResetMessage: " << errorMessage);
+    return false;
+  }
+  return true;
+}
+
+
+size_t vtkMRMLROS2GenericPublisherNode::Publish(void)
+{
+  if (!IsAddedToROS2Node()) {
+    vtkErrorMacro(<< "Publish: publisher is not added to a ROS node");
+    return 0;
+  }
+  mNumberOfCalls++;
+  size_t justSent = 0;
+  std::string errorMessage;
+  if (!(static_cast<vtkMRMLROS2GenericPublisherInternals *>(mInternals))->Publish(justSent, errorMessage)) {
+    vtkErrorMacro(<< "Publish: " << errorMessage);
+  }
+  mNumberOfMessagesSent += justSent;
+  return justSent;
+}
+
+
+void vtkMRMLROS2GenericPublisherNode::WriteXML(std::ostream& of, int nIndent)
+{
+  Superclass::WriteXML(of, nIndent);
+  if ((static_cast<vtkMRMLROS2GenericPublisherInternals *>(mInternals))->HasType()) {
+    vtkMRMLWriteXMLBeginMacro(of);
+    vtkMRMLWriteXMLStdStringMacro(rosType, ROSType);
+    vtkMRMLWriteXMLEndMacro();
+  }
+}
+
+
+void vtkMRMLROS2GenericPublisherNode::ReadXMLAttributes(const char** atts)
+{
+  int wasModifying = this->StartModify();
+  Superclass::ReadXMLAttributes(atts);
+  vtkMRMLReadXMLBeginMacro(atts);
+  vtkMRMLReadXMLStdStringMacro(rosType, ROSType);
+  vtkMRMLReadXMLEndMacro();
+  this->EndModify(wasModifying);
+}
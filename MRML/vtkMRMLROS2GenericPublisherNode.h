@@ -0,0 +1,62 @@
+#ifndef __vtkMRMLROS2GenericPublisherNode_h
+#define __vtkMRMLROS2GenericPublisherNode_h
+
+#include <vtkMRMLROS2PublisherNode.h>
+
+#include <vtkVariant.h>
+
+/*! Publisher for any ROS message type, the type is provided by name
+  at runtime (e.g. "geometry_msgs/msg/PoseStamped") so new message
+  types don't require rebuilding the module.  The message is kept
+  by the publisher, fields are set in place using their path and the
+  same message is sent each time Publish is called. */
+class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2GenericPublisherNode:
+  public vtkMRMLROS2PublisherNode
+{
+ public:
+  typedef vtkMRMLROS2GenericPublisherNode SelfType;
+  vtkTypeMacro(vtkMRMLROS2GenericPublisherNode, vtkMRMLROS2PublisherNode);
+
+  static SelfType * New(void);
+  vtkMRMLNode * CreateNodeInstance(void) override;
+  const char * GetNodeTagName(void) override;
+
+  /*! Set the ROS message type, must be called before AddToROS2Node.
+    Returns false if the type support libraries for this type can't
+    be found or the publisher is already added. */
+  bool SetROSType(const std::string & type);
+
+  /*! Set a field of the message, e.g. "pose.position.x",
+    "header.frame_id" or "data[2]".  Sequences are extended if the
+    index is past their current size.  The value is converted to the
+    field type.  Returns false if the field doesn't exist or the
+    value can't be converted. */
+  bool SetField(const std::string & path, const vtkVariant & value);
+  bool SetField(const std::string & path, const double & value);
+  bool SetField(const std::string & path, const std::string & value);
+
+  /*! Current value of a field, invalid variant if the field doesn't
+    exist. */
+  vtkVariant GetField(const std::string & path);
+
+  /*! Message that will be sent, in YAML format. */
+  std::string GetMessageYAML(void) const;
+
+  /*! Reset all fields to their default values (sequences are
+    emptied). */
+  bool ResetMessage(void);
+
+  /*! Publish the message with its current field values.  Returns the
+    number of subscribers the message was sent to. */
+  size_t Publish(void);
+
+  // Save and load
+  void ReadXMLAttributes(const char** atts) override;
+  void WriteXML(std::ostream& of, int indent) override;
+
+ protected:
+  vtkMRMLROS2GenericPublisherNode();
+  ~vtkMRMLROS2GenericPublisherNode();
+};
+
+#endif // __vtkMRMLROS2GenericPublisherNode_h
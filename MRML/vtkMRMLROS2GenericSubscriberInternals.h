@@ -0,0 +1,97 @@
+#ifndef __vtkMRMLROS2GenericSubscriberInternals_h
+#define __vtkMRMLROS2GenericSubscriberInternals_h
+
+#include <vtkMRMLROS2GenericMessage.h>
+#include <vtkMRMLROS2SubscriberInternals.h>
+
+/*! Internals for subscribers using a message type only known at
+  runtime.  The serialized messages are stored as received and only
+  deserialized when the application reads them. */
+class vtkMRMLROS2GenericSubscriberInternals:
+  public vtkMRMLROS2SubscriberVTKInternals<vtkMRMLROS2GenericMessage, vtkTable>
+{
+public:
+  typedef vtkMRMLROS2SubscriberVTKInternals<vtkMRMLROS2GenericMessage, vtkTable> BaseType;
+
+  vtkMRMLROS2GenericSubscriberInternals(vtkMRMLROS2SubscriberNode * mrmlNode):
+    BaseType(mrmlNode)
+  {}
+
+  bool SetType(const std::string & type, std::string & errorMessage)
+  {
+    std::shared_ptr<const vtkMRMLROS2GenericMessageType> messageType
+      = vtkMRMLROS2GenericMessageType::Create(type, errorMessage);
+    if (!messageType) {
+      return false;
+    }
+    mType = messageType;
+    return true;
+  }
+
+  inline bool HasType(void) const {
+    return (mType != nullptr);
+  }
+
+  const char * GetROSType(void) const override
+  {
+    return mType ? mType->GetName().c_str() : "undefined";
+  }
+
+  bool AddToROS2Node(vtkMRMLNode * nodeInScene, const char * nodeId,
+                     const std::string & topic, std::string & errorMessage) override
+  {
+    if (!mType) {
+      errorMessage = "the ROS type must be set (SetROSType) before the generic subscriber for \"" + topic + "\" is added";
+      return false;
+    }
+    return BaseType::AddToROS2Node(nodeInScene, nodeId, topic, errorMessage);
+  }
+
+  bool GetLastMessageField(const std::string & path, vtkVariant & result, std::string & errorMessage) const
+  {
+    std::shared_ptr<const vtkMRMLROS2GenericMessage> message = this->GetLastMessageROS();
+    const void * data = message->GetData(errorMessage);
+    if (data == nullptr) {
+      return false;
+    }
+    return message->GetType()->GetField(data, path, result, errorMessage);
+  }
+
+  /*! Deserialize the latest message if needed.  Returns false and
+    sets the error message if the message can't be deserialized, no
+    message received yet is not an error. */
+  bool CheckLastMessage(std::string & errorMessage) const
+  {
+    std::shared_ptr<const vtkMRMLROS2GenericMessage> message = this->GetLastMessageROS();
+    return message->IsEmpty() || (message->GetData(errorMessage) != nullptr);
+  }
+
+  bool UpdateMRMLNode(vtkMRMLNode * node, const int & row, std::string & errorMessage) override
+  {
+    if (!CheckLastMessage(errorMessage)) {
+      return false;
+    }
+    return BaseType::UpdateMRMLNode(node, row, errorMessage);
+  }
+
+protected:
+  std::shared_ptr<const vtkMRMLROS2GenericMessageType> mType;
+
+  rclcpp::SubscriptionBase::SharedPtr
+  CreateSubscription(const std::string & topic, const rclcpp::QoS & qos,
+                     CallbackType callback, const rclcpp::SubscriptionOptions & options) override
+  {
+    // serialized messages can't use intra-process communications
+    rclcpp::SubscriptionOptions genericOptions = options;
+    genericOptions.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+    std::shared_ptr<const vtkMRMLROS2GenericMessageType> type = mType;
+    return this->mROSNode->create_generic_subscription(topic, mType->GetName(), qos,
+                                                       [type, callback](std::shared_ptr<rclcpp::SerializedMessage> serialized) {
+                                                         // no copy nor deserialization here, see vtkMRMLROS2GenericMessage::GetData
+                                                         callback(std::make_shared<const vtkMRMLROS2GenericMessage>(type, std::move(serialized)));
+                                                       },
+                                                       genericOptions);
+  }
+};
+
+#endif // __vtkMRMLROS2GenericSubscriberInternals_h
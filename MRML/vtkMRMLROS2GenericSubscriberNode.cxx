@@ -0,0 +1,109 @@
+#include <vtkROS2ToSlicer.h>
+
+#include <vtkMRMLROS2GenericSubscriberNode.h>
+#include <vtkMRMLROS2GenericSubscriberInternals.h>
+
+vtkStandardNewMacro(vtkMRMLROS2GenericSubscriberNode);
+
+
+vtkMRMLROS2GenericSubscriberNode::vtkMRMLROS2GenericSubscriberNode()
+{
+  mInternals = new vtkMRMLROS2GenericSubscriberInternals(this);
+}
+
+
+vtkMRMLROS2GenericSubscriberNode::~vtkMRMLROS2GenericSubscriberNode()
+{
+  delete mInternals;
+}
+
+
+vtkMRMLNode * vtkMRMLROS2GenericSubscriberNode::CreateNodeInstance(void)
+{
+  return SelfType::New();
+}
+
+
+const char * vtkMRMLROS2GenericSubscriberNode::GetNodeTagName(void)
+{
+  return "ROS2GenericSubscriber";
+}
+
+
+bool vtkMRMLROS2GenericSubscriberNode::SetROSType(const std::string & type)
+{
+  if (IsAddedToROS2Node()) {
+    vtkErrorMacro(<< "SetROSType: type must be set before the subscriber for topic \"" << mTopic << "\" is added to the ROS node");
+    return false;
+  }
+  std::string errorMessage;
+  if (!(static_cast<vtkMRMLROS2GenericSubscriberInternals *>(mInternals))->SetType(type, errorMessage)) {
+    vtkErrorMacro(<< "SetROSType: " << errorMessage);
+    return false;
+  }
+  return true;
+}
+
+
+void vtkMRMLROS2GenericSubscriberNode::CheckLastMessage(const char * methodName) const
+{
+  std::string errorMessage;
+  if (!(static_cast<vtkMRMLROS2GenericSubscriberInternals *>(mInternals))->CheckLastMessage(errorMessage)) {
+    vtkErrorMacro(<< methodName << ": " << errorMessage << " on topic \"" << mTopic << "\"");
+  }
+}
+
+
+void vtkMRMLROS2GenericSubscriberNode::GetLastMessage(vtkTable * message) const
+{
+  CheckLastMessage("GetLastMessage");
+  (static_cast<vtkMRMLROS2GenericSubscriberInternals *>(mInternals))->GetLastMessage(message);
+}
+
+
+vtkTable * vtkMRMLROS2GenericSubscriberNode::GetLastMessage(void) const
+{
+  CheckLastMessage("GetLastMessage");
+  return (static_cast<vtkMRMLROS2GenericSubscriberInternals *>(mInternals))->GetCachedLastMessage();
+}
+
+
+vtkVariant vtkMRMLROS2GenericSubscriberNode::GetLastMessageVariant(void)
+{
+  CheckLastMessage("GetLastMessageVariant");
+  return (static_cast<vtkMRMLROS2GenericSubscriberInternals *>(mInternals))->GetLastMessageVariant();
+}
+
+
+vtkVariant vtkMRMLROS2GenericSubscriberNode::GetLastMessageField(const std::string & path)
+{
+  vtkVariant result;
+  std::string errorMessage;
+  if (!(static_cast<vtkMRMLROS2GenericSubscriberInternals *>(mInternals))->GetLastMessageField(path, result, errorMessage)) {
+    vtkErrorMacro(<< "GetLastMessageField: " << errorMessage);
+    return vtkVariant();
+  }
+  return result;
+}
+
+
+void vtkMRMLROS2GenericSubscriberNode::WriteXML(std::ostream& of, int nIndent)
+{
+  Superclass::WriteXML(of, nIndent);
+  if ((static_cast<vtkMRMLROS2GenericSubscriberInternals *>(mInternals))->HasType()) {
+    vtkMRMLWriteXMLBeginMacro(of);
+    vtkMRMLWriteXMLStdStringMacro(rosType, ROSType);
+    vtkMRMLWriteXMLEndMacro();
+  }
+}
+
+
+void vtkMRMLROS2GenericSubscriberNode::ReadXMLAttributes(const char** atts)
+{
+  int wasModifying = this->StartModify();
+  Superclass::ReadXMLAttributes(atts);
+  vtkMRMLReadXMLBeginMacro(atts);
+  vtkMRMLReadXMLStdStringMacro(rosType, ROSType);
+  vtkMRMLReadXMLEndMacro();
+  this->EndModify(wasModifying);
+}
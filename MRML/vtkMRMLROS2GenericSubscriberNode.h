@@ -0,0 +1,56 @@
+#ifndef __vtkMRMLROS2GenericSubscriberNode_h
+#define __vtkMRMLROS2GenericSubscriberNode_h
+
+#include <vtkMRMLROS2SubscriberNode.h>
+
+class vtkTable;
+
+/*! Subscriber for any ROS message type, the type is provided by name
+  at runtime (e.g. "geometry_msgs/msg/PoseStamped") so new message
+  types don't require rebuilding the module.  Messages are kept
+  serialized and deserialized only when read. */
+class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2GenericSubscriberNode:
+  public vtkMRMLROS2SubscriberNode
+{
+ public:
+  typedef vtkMRMLROS2GenericSubscriberNode SelfType;
+  vtkTypeMacro(vtkMRMLROS2GenericSubscriberNode, vtkMRMLROS2SubscriberNode);
+
+  static SelfType * New(void);
+  vtkMRMLNode * CreateNodeInstance(void) override;
+  const char * GetNodeTagName(void) override;
+
+  /*! Set the ROS message type, must be called before AddToROS2Node.
+    Returns false if the type support libraries for this type can't
+    be found or the subscriber is already added. */
+  bool SetROSType(const std::string & type);
+
+  /*! Latest message as a table with a single row and one column per
+    field.  Columns are named after the field paths (e.g.
+    "pose.position.x", "poses[2].position.x").  Sequences and arrays
+    of numbers or strings (e.g. "data") use a single column with one
+    component per element.  Numeric fields are converted to doubles.
+    Messages that can't be deserialized are reported as errors and
+    result in an empty table. */
+  void GetLastMessage(vtkTable * message) const;
+  vtkTable * GetLastMessage(void) const;
+  vtkVariant GetLastMessageVariant(void) override;
+
+  /*! Value of a field of the latest message, e.g. "pose.position.x"
+    or "data[2]".  Returns an invalid variant if there is no such
+    field. */
+  vtkVariant GetLastMessageField(const std::string & path);
+
+  // Save and load
+  void ReadXMLAttributes(const char** atts) override;
+  void WriteXML(std::ostream& of, int indent) override;
+
+ protected:
+  vtkMRMLROS2GenericSubscriberNode();
+  ~vtkMRMLROS2GenericSubscriberNode();
+
+  /*! Report an error if the latest message can't be deserialized. */
+  void CheckLastMessage(const char * methodName) const;
+};
+
+#endif // __vtkMRMLROS2GenericSubscriberNode_h
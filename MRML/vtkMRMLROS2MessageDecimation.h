@@ -0,0 +1,91 @@
+#ifndef __vtkMRMLROS2MessageDecimation_h
+#define __vtkMRMLROS2MessageDecimation_h
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+/*! Decide which messages received by a subscriber are kept.  A
+  message is kept if it passes all the enabled criteria: every Nth
+  message, a maximum rate and a minimum change of the message values
+  (see vtkROS2ToSlicerValues).  Settings can be changed from any
+  thread, Accept must always be called from the same thread (the
+  subscription callback). */
+class vtkMRMLROS2MessageDecimation
+{
+public:
+  vtkMRMLROS2MessageDecimation() = default;
+  vtkMRMLROS2MessageDecimation(const vtkMRMLROS2MessageDecimation &) = delete;
+  vtkMRMLROS2MessageDecimation & operator = (const vtkMRMLROS2MessageDecimation &) = delete;
+
+  /*! Keep one message out of everyNth, 1 to disable. */
+  inline void SetEveryNth(const size_t & everyNth) {
+    mEveryNth.store(everyNth == 0 ? 1 : everyNth);
+  }
+
+  /*! Maximum rate in Hz, 0 to disable. */
+  inline void SetMaximumRate(const double & rate) {
+    mMaximumRate.store(rate);
+  }
+
+  /*! Minimum change for any value compared to the last message kept,
+    0 to disable. */
+  inline void SetMinimumChange(const double & change) {
+    mMinimumChange.store(change);
+  }
+
+  inline bool IsEnabled(void) const {
+    return (mEveryNth.load() > 1)
+      || (mMaximumRate.load() > 0.0)
+      || (mMinimumChange.load() > 0.0);
+  }
+
+  inline bool UsesValues(void) const {
+    return mMinimumChange.load() > 0.0;
+  }
+
+  /*! Returns true if the message should be kept.  Time is in
+    milliseconds.  Values can be null if the message can't be
+    represented as numbers, the minimum change is then ignored. */
+  bool Accept(const double & time, const std::vector<double> * values)
+  {
+    const size_t everyNth = mEveryNth.load();
+    const size_t counter = mCounter++;
+    if ((everyNth > 1) && ((counter % everyNth) != 0)) {
+      return false;
+    }
+    const double rate = mMaximumRate.load();
+    if ((rate > 0.0) && ((time - mLastTime) < (1000.0 / rate))) {
+      return false;
+    }
+    const double change = mMinimumChange.load();
+    if ((change > 0.0) && values && (values->size() == mLastValues.size())) {
+      double maxDifference = 0.0;
+      for (size_t index = 0; index < mLastValues.size(); ++index) {
+        maxDifference = std::max(maxDifference, std::abs((*values)[index] - mLastValues[index]));
+      }
+      if (maxDifference < change) {
+        return false;
+      }
+    }
+    mLastTime = time;
+    if (values) {
+      mLastValues = *values;
+    }
+    return true;
+  }
+
+protected:
+  std::atomic<size_t> mEveryNth{1};
+  std::atomic<double> mMaximumRate{0.0};
+  std::atomic<double> mMinimumChange{0.0};
+
+  // callback thread only
+  size_t mCounter = 0;
+  double mLastTime = -std::numeric_limits<double>::infinity();
+  std::vector<double> mLastValues;
+};
+
+#endif // __vtkMRMLROS2MessageDecimation_h
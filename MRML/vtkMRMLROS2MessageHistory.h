@@ -0,0 +1,188 @@
+#ifndef __vtkMRMLROS2MessageHistory_h
+#define __vtkMRMLROS2MessageHistory_h
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/*! History of the latest messages received by a subscriber.  The
+  history itself is only accessed by the MRML thread.  Messages
+  received by a background thread are passed using a lock-free single
+  producer/single consumer ring of the latest samples (see Push) and
+  moved to the history by the MRML thread (see Drain).  Like
+  vtkMRMLROS2MessageSlot, each element of the ring is an atomic
+  pointer so the producer overwrites the oldest sample instead of
+  blocking or dropping the newest one.  Messages are not copied, the
+  history keeps shared pointers. */
+template <typename _type>
+class vtkMRMLROS2MessageHistory
+{
+public:
+  struct Sample {
+    size_t Version = 0; // see vtkMRMLROS2SubscriberNode::GetLastMessageVersion
+    double Time = 0.0;  // reception time, in seconds
+    std::shared_ptr<_type> Message;
+  };
+
+  vtkMRMLROS2MessageHistory() = default;
+  vtkMRMLROS2MessageHistory(const vtkMRMLROS2MessageHistory &) = delete;
+  vtkMRMLROS2MessageHistory & operator = (const vtkMRMLROS2MessageHistory &) = delete;
+
+  ~vtkMRMLROS2MessageHistory()
+  {
+    ClearRing();
+  }
+
+  /*! Set the number of messages kept, 0 to disable.  This is not
+    thread safe, it must be called before any producer is started. */
+  void SetDepth(const size_t & depth)
+  {
+    mSamples.clear();
+    mSamples.resize(depth);
+    mNext = 0;
+    mSize = 0;
+    ClearRing();
+    mRing = std::vector<std::atomic<Sample *>>(depth);
+    for (auto & element : mRing) {
+      element.store(nullptr, std::memory_order_relaxed);
+    }
+    mNumberOfPushes = 0;
+    mNumberOfPushesDrained = 0;
+    mLastDrainedVersion = 0;
+    mNumberOfDroppedMessages = 0;
+  }
+
+  /*! Reception time used for the samples, in seconds since epoch. */
+  static double Now(void)
+  {
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+  }
+
+  inline size_t GetDepth(void) const {
+    return mSamples.size();
+  }
+
+  inline size_t GetSize(void) const {
+    return mSize;
+  }
+
+  /*! Called by the background producer.  If the ring is full, i.e.
+    the MRML thread didn't drain it for a whole history depth, the
+    oldest sample is replaced and counted as dropped (see
+    GetNumberOfDroppedMessages).  Versions must be increasing and
+    strictly positive. */
+  void Push(const size_t & version, const double & time, std::shared_ptr<_type> message)
+  {
+    if (mRing.empty()) {
+      return;
+    }
+    const size_t index = mNumberOfPushes.load(std::memory_order_relaxed);
+    Sample * previous
+      = mRing[index % mRing.size()].exchange(new Sample{version, time, std::move(message)},
+                                             std::memory_order_acq_rel);
+    if (previous != nullptr) {
+      delete previous;
+      mNumberOfDroppedMessages.fetch_add(1, std::memory_order_relaxed);
+    }
+    mNumberOfPushes.store(index + 1, std::memory_order_release);
+  }
+
+  /*! Called by the MRML thread to move the samples pushed by the
+    background producer to the history. */
+  void Drain(void)
+  {
+    const size_t numberOfPushes = mNumberOfPushes.load(std::memory_order_acquire);
+    if (numberOfPushes == mNumberOfPushesDrained) {
+      return;
+    }
+    // older elements have been replaced, the producer might also have
+    // replaced some of the ones below while we drain them
+    const size_t depth = mRing.size();
+    const size_t first = std::max(mNumberOfPushesDrained,
+                                  (numberOfPushes > depth) ? numberOfPushes - depth : 0);
+    mDrained.clear();
+    for (size_t index = first; index < numberOfPushes; ++index) {
+      Sample * sample = mRing[index % depth].exchange(nullptr, std::memory_order_acq_rel);
+      if (sample != nullptr) {
+        mDrained.push_back(sample);
+      }
+    }
+    mNumberOfPushesDrained = numberOfPushes;
+    std::sort(mDrained.begin(), mDrained.end(),
+              [](const Sample * a, const Sample * b) { return a->Version < b->Version; });
+    for (Sample * sample : mDrained) {
+      // a sample taken ahead of its turn during the previous drain is
+      // newer, the older ones can't be added to the history anymore
+      if (sample->Version > mLastDrainedVersion) {
+        mLastDrainedVersion = sample->Version;
+        Add(sample->Version, sample->Time, std::move(sample->Message));
+      } else {
+        mNumberOfDroppedMessages.fetch_add(1, std::memory_order_relaxed);
+      }
+      delete sample;
+    }
+  }
+
+  /*! Called by the MRML thread, either for messages received on the
+    MRML thread or by Drain. */
+  void Add(const size_t & version, const double & time, std::shared_ptr<_type> message)
+  {
+    if (mSamples.empty()) {
+      return;
+    }
+    Sample & sample = mSamples[mNext];
+    sample.Version = version;
+    sample.Time = time;
+    sample.Message = std::move(message);
+    mNext = (mNext + 1) % mSamples.size();
+    if (mSize < mSamples.size()) {
+      mSize++;
+    }
+  }
+
+  /*! Samples more recent than version, from oldest to newest.
+    Pointers are valid until the next call to Add or Drain. */
+  void GetSamplesSince(const size_t & version, std::vector<const Sample *> & result) const
+  {
+    result.clear();
+    const size_t depth = mSamples.size();
+    for (size_t index = 0; index < mSize; ++index) {
+      const Sample & sample = mSamples[(mNext + depth - mSize + index) % depth];
+      if (sample.Version > version) {
+        result.push_back(&sample);
+      }
+    }
+  }
+
+  /*! Number of samples pushed by the background producer and
+    replaced by newer ones before the MRML thread could drain them. */
+  inline size_t GetNumberOfDroppedMessages(void) const {
+    return mNumberOfDroppedMessages.load(std::memory_order_relaxed);
+  }
+
+protected:
+  void ClearRing(void)
+  {
+    for (auto & element : mRing) {
+      delete element.exchange(nullptr);
+    }
+  }
+
+  // MRML thread only
+  std::vector<Sample> mSamples;
+  size_t mNext = 0;
+  size_t mSize = 0;
+
+  // single producer/single consumer ring, the latest sample is at
+  // (mNumberOfPushes - 1) % depth
+  std::vector<std::atomic<Sample *>> mRing;
+  std::atomic<size_t> mNumberOfPushes{0};
+  size_t mNumberOfPushesDrained = 0; // MRML thread only
+  size_t mLastDrainedVersion = 0;    // MRML thread only
+  std::vector<Sample *> mDrained;    // MRML thread only
+  std::atomic<size_t> mNumberOfDroppedMessages{0};
+};
+
+#endif // __vtkMRMLROS2MessageHistory_h
@@ -0,0 +1,65 @@
+#ifndef __vtkMRMLROS2MessageSlot_h
+#define __vtkMRMLROS2MessageSlot_h
+
+#include <atomic>
+#include <memory>
+
+/*! Lock-free hand-off of the latest message between a single
+  producer (the ROS executor thread) and a single consumer (the MRML
+  thread).  Only the latest message is kept, if the producer puts a
+  new message before the consumer took the previous one, the previous
+  one is released by the producer. */
+template <typename _type>
+class vtkMRMLROS2MessageSlot
+{
+public:
+  vtkMRMLROS2MessageSlot() = default;
+  vtkMRMLROS2MessageSlot(const vtkMRMLROS2MessageSlot &) = delete;
+  vtkMRMLROS2MessageSlot & operator = (const vtkMRMLROS2MessageSlot &) = delete;
+
+  ~vtkMRMLROS2MessageSlot()
+  {
+    delete mLatest.exchange(nullptr);
+  }
+
+  /*! Called by the producer.  Returns true if the slot was empty,
+    i.e. the consumer has already taken the previous message. */
+  bool Put(std::shared_ptr<_type> message)
+  {
+    mNumberOfPuts.fetch_add(1, std::memory_order_relaxed);
+    std::shared_ptr<_type> * previous
+      = mLatest.exchange(new std::shared_ptr<_type>(std::move(message)),
+                         std::memory_order_acq_rel);
+    if (previous == nullptr) {
+      return true;
+    }
+    delete previous;
+    return false;
+  }
+
+  /*! Called by the consumer.  Returns the latest message or nullptr
+    if no message has been put since the last call. */
+  std::shared_ptr<_type> Take(void)
+  {
+    std::shared_ptr<_type> * latest = mLatest.exchange(nullptr, std::memory_order_acq_rel);
+    if (latest == nullptr) {
+      return nullptr;
+    }
+    std::shared_ptr<_type> result = std::move(*latest);
+    delete latest;
+    return result;
+  }
+
+  /*! Total number of messages put in the slot, including the ones
+    replaced before the consumer could take them. */
+  size_t GetNumberOfPuts(void) const
+  {
+    return mNumberOfPuts.load(std::memory_order_relaxed);
+  }
+
+protected:
+  std::atomic<std::shared_ptr<_type> *> mLatest{nullptr};
+  std::atomic<size_t> mNumberOfPuts{0};
+};
+
+#endif // __vtkMRMLROS2MessageSlot_h
@@ -1,16 +1,142 @@
 #ifndef __vtkMRMLROS2NodeInternals_h
 #define __vtkMRMLROS2NodeInternals_h
 
+#include <atomic>
+#include <thread>
+
 #include <rclcpp/rclcpp.hpp>
+#include <rclcpp/parameter_service.hpp>
+#if __has_include(<rclcpp/version.h>)
+#include <rclcpp/version.h>
+#endif
 #include <tf2_ros/buffer.h>
 #include <tf2_ros/transform_listener.h>
 
+/*! Services interface adding all services and clients to a given
+  callback group.  rclcpp::ParameterService always uses the node's
+  default callback group, this is used to move the ROS parameter
+  services to the background callback group. */
+class vtkMRMLROS2NodeServicesInGroup: public rclcpp::node_interfaces::NodeServicesInterface
+{
+ public:
+  vtkMRMLROS2NodeServicesInGroup(rclcpp::node_interfaces::NodeServicesInterface::SharedPtr services,
+                                 rclcpp::CallbackGroup::SharedPtr group):
+    mServices(services),
+    mGroup(group)
+  {}
+
+  void add_client(rclcpp::ClientBase::SharedPtr client,
+                  rclcpp::CallbackGroup::SharedPtr) override
+  {
+    mServices->add_client(client, mGroup);
+  }
+
+  void add_service(rclcpp::ServiceBase::SharedPtr service,
+                   rclcpp::CallbackGroup::SharedPtr) override
+  {
+    mServices->add_service(service, mGroup);
+  }
+
+#if defined(RCLCPP_VERSION_MAJOR) && (RCLCPP_VERSION_MAJOR >= 16)
+  std::string resolve_service_name(const std::string & name, bool only_expand = false) const override
+  {
+    return mServices->resolve_service_name(name, only_expand);
+  }
+#endif
+
+ protected:
+  rclcpp::node_interfaces::NodeServicesInterface::SharedPtr mServices;
+  rclcpp::CallbackGroup::SharedPtr mGroup;
+};
+
 class vtkMRMLROS2NodeInternals
 {
  public:
+  ~vtkMRMLROS2NodeInternals()
+  {
+    StopBackgroundExecutor();
+  }
+
+  /*! Create a callback group that is not spun by rclcpp::spin_some
+    and a dedicated executor/thread to execute its callbacks.  The ROS
+    parameter services are always created in this group (the node
+    must be created with start_parameter_services set to false) so
+    nodes don't have to be polled for them.  If the node spins in
+    background, subscribers created after this will also use the
+    background callback group. */
+  void StartBackgroundExecutor(void)
+  {
+    mBackgroundCallbackGroup
+      = mNodePointer->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive,
+                                            false /* not automatically added to executors */);
+    auto servicesInGroup
+      = std::make_shared<vtkMRMLROS2NodeServicesInGroup>(mNodePointer->get_node_services_interface(),
+                                                         mBackgroundCallbackGroup);
+    mParameterService
+      = std::make_shared<rclcpp::ParameterService>(mNodePointer->get_node_base_interface(),
+                                                   servicesInGroup,
+                                                   mNodePointer->get_node_parameters_interface().get());
+    mBackgroundExecutor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+    mBackgroundExecutor->add_callback_group(mBackgroundCallbackGroup,
+                                            mNodePointer->get_node_base_interface());
+    mStopBackgroundExecutor = false;
+    mBackgroundThread = std::thread([this]() {
+      while (!mStopBackgroundExecutor && rclcpp::ok()) {
+        mBackgroundExecutor->spin_once(std::chrono::milliseconds(100));
+      }
+    });
+  }
+
+  void StopBackgroundExecutor(void)
+  {
+    if (!mBackgroundExecutor) {
+      return;
+    }
+    mStopBackgroundExecutor = true;
+    mBackgroundExecutor->cancel();
+    if (mBackgroundThread.joinable()) {
+      mBackgroundThread.join();
+    }
+    mBackgroundExecutor.reset();
+    mParameterService.reset();
+    mBackgroundCallbackGroup.reset();
+  }
+
+  /*! Returns true if the node has subscriptions, services, timers or
+    clients in a callback group spun by the executor the node is added
+    to, i.e. any group but the excluded one.  Other waitables, e.g. the
+    publishers' QoS events, don't need to be handled right away and
+    are executed at the next spin. */
+  static bool HasForegroundEntities(const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr & nodeBase,
+                                    const rclcpp::CallbackGroup::SharedPtr & excludedGroup = nullptr)
+  {
+    const auto any = [](const auto &) { return true; };
+    for (auto & weakGroup : nodeBase->get_callback_groups()) {
+      auto group = weakGroup.lock();
+      if (group
+          && (group != excludedGroup)
+          && group->automatically_add_to_executor_with_node()
+          && (group->find_subscription_ptrs_if(any)
+              || group->find_service_ptrs_if(any)
+              || group->find_client_ptrs_if(any)
+              || group->find_timer_ptrs_if(any))) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   std::shared_ptr<rclcpp::Node> mNodePointer;
   std::shared_ptr<tf2_ros::Buffer> mTf2Buffer;
   std::shared_ptr<tf2_ros::TransformListener> mTf2Listener;
+
+  // background executor, used by the parameter services and the
+  // subscribers if the node spins in background
+  rclcpp::CallbackGroup::SharedPtr mBackgroundCallbackGroup;
+  std::shared_ptr<rclcpp::ParameterService> mParameterService;
+  std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> mBackgroundExecutor;
+  std::thread mBackgroundThread;
+  std::atomic<bool> mStopBackgroundExecutor{false};
 };
 
 #endif // __vtkMRMLROS2NodeInternals_h
@@ -5,8 +5,11 @@
 
 #include <vtkROS2ToSlicer.h>
 #include <vtkMRMLROS2NodeInternals.h>
+#include <vtkMRMLROS2Tracer.h>
 #include <vtkMRMLROS2SubscriberNode.h>
+#include <vtkMRMLROS2GenericSubscriberNode.h>
 #include <vtkMRMLROS2PublisherNode.h>
+#include <vtkMRMLROS2GenericPublisherNode.h>
 #include <vtkMRMLROS2ParameterNode.h>
 #include <vtkMRMLROS2Tf2BroadcasterNode.h>
 #include <vtkMRMLROS2Tf2LookupNode.h>
@@ -32,6 +35,8 @@ vtkMRMLROS2NodeNode::vtkMRMLROS2NodeNode()
 {
   mInternals = std::make_unique<vtkMRMLROS2NodeInternals>();
   mTemporaryMatrix = vtkMatrix4x4::New();
+  mSpinStatistics = vtkSmartPointer<vtkMRMLROS2TimeStatistics>::New();
+  mTf2BufferStatistics = vtkSmartPointer<vtkMRMLROS2TimeStatistics>::New();
 }
 
 
@@ -47,13 +52,25 @@ void vtkMRMLROS2NodeNode::PrintSelf(ostream& os, vtkIndent indent)
 }
 
 
-void vtkMRMLROS2NodeNode::Create(const std::string & nodeName)
+void vtkMRMLROS2NodeNode::Create(const std::string & nodeName, const bool & spinInBackground,
+                                 const bool & intraProcess)
 {
   // create the ROS node
   mROS2NodeName = nodeName;
+  mSpinInBackground = spinInBackground;
+  mIntraProcess = intraProcess;
   mMRMLNodeName = "ros2:node:" + nodeName;
   this->SetName(mMRMLNodeName.c_str());
-  mInternals->mNodePointer = std::make_shared<rclcpp::Node>(nodeName);
+  // in case Create is called more than once
+  mInternals->StopBackgroundExecutor();
+  // the parameter services are created by the internals in the
+  // background callback group, see StartBackgroundExecutor
+  mInternals->mNodePointer
+    = std::make_shared<rclcpp::Node>(nodeName,
+                                     rclcpp::NodeOptions()
+                                     .use_intra_process_comms(mIntraProcess)
+                                     .start_parameter_services(false));
+  mInternals->StartBackgroundExecutor();
 }
 
 
@@ -68,6 +85,7 @@ void vtkMRMLROS2NodeNode::Destroy()
   mMRMLNodeName = "ros2:node:undefined";
   this->SetName(mMRMLNodeName.c_str());
   this->Scene->RemoveNode(this);
+  mInternals->StopBackgroundExecutor();
   mInternals->mNodePointer.reset();
   mInternals.reset();
 }
@@ -100,6 +118,28 @@ vtkMRMLROS2SubscriberNode * vtkMRMLROS2NodeNode::CreateAndAddSubscriberNode(cons
 }
 
 
+vtkMRMLROS2GenericSubscriberNode * vtkMRMLROS2NodeNode::CreateAndAddGenericSubscriberNode(const std::string & rosType, const std::string & topic)
+{
+  // Check if this has been added to the scene
+  if (this->GetScene() == nullptr) {
+    vtkErrorMacro(<< "CreateAndAddGenericSubscriber: \"" << mROS2NodeName << "\" must be added to a MRML scene first");
+    return nullptr;
+  }
+  vtkSmartPointer<vtkMRMLROS2GenericSubscriberNode> subscriberNode = vtkSmartPointer<vtkMRMLROS2GenericSubscriberNode>::New();
+  if (!subscriberNode->SetROSType(rosType)) {
+    return nullptr;
+  }
+  // Add to the scene so the ROS2Node node can find it
+  this->GetScene()->AddNode(subscriberNode);
+  if (subscriberNode->AddToROS2Node(this->GetID(), topic)) {
+    return subscriberNode;
+  }
+  // Something went wrong, cleanup
+  this->GetScene()->RemoveNode(subscriberNode);
+  return nullptr;
+}
+
+
 vtkMRMLROS2PublisherNode * vtkMRMLROS2NodeNode::CreateAndAddPublisherNode(const char * className, const std::string & topic)
 {
   // Check if this has been added to the scene
@@ -127,6 +167,28 @@ vtkMRMLROS2PublisherNode * vtkMRMLROS2NodeNode::CreateAndAddPublisherNode(const
 }
 
 
+vtkMRMLROS2GenericPublisherNode * vtkMRMLROS2NodeNode::CreateAndAddGenericPublisherNode(const std::string & rosType, const std::string & topic)
+{
+  // Check if this has been added to the scene
+  if (this->GetScene() == nullptr) {
+    vtkErrorMacro(<< "CreateAndAddGenericPublisher: \"" << mROS2NodeName << "\" must be added to a MRML scene first");
+    return nullptr;
+  }
+  vtkSmartPointer<vtkMRMLROS2GenericPublisherNode> publisherNode = vtkSmartPointer<vtkMRMLROS2GenericPublisherNode>::New();
+  if (!publisherNode->SetROSType(rosType)) {
+    return nullptr;
+  }
+  // Add to the scene so the ROS2Node node can find it
+  this->GetScene()->AddNode(publisherNode);
+  if (publisherNode->AddToROS2Node(this->GetID(), topic)) {
+    return publisherNode;
+  }
+  // Something went wrong, cleanup
+  this->GetScene()->RemoveNode(publisherNode);
+  return nullptr;
+}
+
+
 vtkMRMLROS2ParameterNode * vtkMRMLROS2NodeNode::CreateAndAddParameterNode(const std::string & monitoredNodeName)
 {
   // Check if this has been added to the scene
@@ -511,6 +573,8 @@ bool vtkMRMLROS2NodeNode::SetTf2Buffer(void)
 void vtkMRMLROS2NodeNode::SpinTf2Buffer(void)
 {
   if (mInternals->mTf2Buffer != nullptr) {
+    vtkMRMLROS2Tracer::Scope trace("tf2", "SpinTf2Buffer", mROS2NodeName);
+    const double start = vtkMRMLROS2TimeStatistics::Now();
     // iterate through lookup nodes - make sure they have parent and children set and call lookup try catch
     int nbLookupRefs = this->GetNumberOfNodeReferences("lookup");
     for (int i = 0; i < nbLookupRefs; i ++) {
@@ -520,10 +584,14 @@ void vtkMRMLROS2NodeNode::SpinTf2Buffer(void)
       try {
         geometry_msgs::msg::TransformStamped transformStamped;
         // check how old we want the data to be (right now it's doing it no matter how old) - for now we don't care
-        transformStamped = mInternals->mTf2Buffer->lookupTransform(parent_id, child_id, tf2::TimePointZero);
+        {
+          vtkMRMLROS2Tracer::Scope traceLookup("tf2", "lookupTransform", parent_id, child_id);
+          transformStamped = mInternals->mTf2Buffer->lookupTransform(parent_id, child_id, tf2::TimePointZero);
+        }
         if (lookupNode->IsDifferentFromLast(transformStamped.header.stamp.sec, transformStamped.header.stamp.nanosec)) {
           vtkROS2ToSlicer(transformStamped, mTemporaryMatrix);
           if (lookupNode->GetModifiedOnLookup()) {
+            vtkMRMLROS2Tracer::Scope traceModified("mrml", "Modified", child_id);
             lookupNode->SetMatrixTransformToParent(mTemporaryMatrix);
           } else {
             lookupNode->DisableModifiedEventOn();
@@ -539,27 +607,156 @@ void vtkMRMLROS2NodeNode::SpinTf2Buffer(void)
         vtkErrorMacro(<< "SpinTf2Buffer on \"" << mMRMLNodeName << ": undefined exception while looking up transform between " << parent_id << " and " << child_id);
       }
     }
+    mTf2BufferStatistics->AddSample(vtkMRMLROS2TimeStatistics::Now() - start);
   }
 }
 
 
+bool vtkMRMLROS2NodeNode::SpinBackgroundSubscribers(const std::chrono::steady_clock::time_point & deadline)
+{
+  const int nbSubscriberRefs = this->GetNumberOfNodeReferences("subscriber");
+  if (mNextBackgroundSubscriber >= nbSubscriberRefs) {
+    mNextBackgroundSubscriber = 0;
+  }
+  // round robin so subscribers skipped when the deadline is reached
+  // are served first next time.  At least one subscriber is updated
+  // per call so a deadline already reached can't starve them.
+  for (int count = 0; count < nbSubscriberRefs; count ++) {
+    if ((count > 0) && (std::chrono::steady_clock::now() >= deadline)) {
+      return false;
+    }
+    vtkMRMLROS2SubscriberNode * subscriberNode = vtkMRMLROS2SubscriberNode::SafeDownCast(this->GetNthNodeReference("subscriber", mNextBackgroundSubscriber));
+    mNextBackgroundSubscriber = (mNextBackgroundSubscriber + 1) % nbSubscriberRefs;
+    if (subscriberNode != nullptr) {
+      subscriberNode->MoveLatestMessage();
+    }
+  }
+  return true;
+}
+
+
 void vtkMRMLROS2NodeNode::Spin(void)
 {
-  if (rclcpp::ok()) {
-    mSpinning = true;
-    // for all ROS callbacks
-    rclcpp::spin_some(mInternals->mNodePointer);
-    // parameters
-    for (auto & node : this->mParameterNodes) {
-      if (node != nullptr) {
-        node->Spin();
-      }
+  if (!mInternals || !mInternals->mNodePointer) {
+    vtkErrorMacro(<< "Spin: the ROS node has not been created for \"" << GetName() << "\"");
+    return;
+  }
+  // a node already added to an executor (e.g. the module's logic) is
+  // spun by it, rclcpp::spin_some would throw
+  const bool ownedByExecutor
+    = mInternals->mNodePointer->get_node_base_interface()->get_associated_with_executor_atomic().load();
+  if (rclcpp::ok() && !ownedByExecutor) {
+    // for all ROS callbacks not handled in the background
+    try {
+      rclcpp::spin_some(mInternals->mNodePointer);
     }
-    // tf2 lookups / buffer
-    SpinTf2Buffer();
-  } else {
+    catch (std::exception & e) {
+      vtkErrorMacro(<< "Spin: unable to spin \"" << mROS2NodeName << "\", " << e.what());
+    }
+  }
+  SpinMRML();
+  FlushModifiedEvents();
+  UpdateDrivenNodes();
+  PublishObservedNodes();
+}
+
+
+void vtkMRMLROS2NodeNode::FlushModifiedEvents(void)
+{
+  const int nbSubscriberRefs = this->GetNumberOfNodeReferences("subscriber");
+  for (int i = 0; i < nbSubscriberRefs; i ++) {
+    vtkMRMLROS2SubscriberNode * subscriberNode = vtkMRMLROS2SubscriberNode::SafeDownCast(this->GetNthNodeReference("subscriber", i));
+    if ((subscriberNode != nullptr) && subscriberNode->GetCoalesceModifiedEvents()) {
+      subscriberNode->FlushModifiedEvent();
+    }
+  }
+}
+
+
+size_t vtkMRMLROS2NodeNode::UpdateDrivenNodes(void)
+{
+  size_t numberOfUpdated = 0;
+  const int nbSubscriberRefs = this->GetNumberOfNodeReferences("subscriber");
+  for (int i = 0; i < nbSubscriberRefs; i ++) {
+    vtkMRMLROS2SubscriberNode * subscriberNode = vtkMRMLROS2SubscriberNode::SafeDownCast(this->GetNthNodeReference("subscriber", i));
+    if ((subscriberNode != nullptr) && subscriberNode->UpdateDrivenNode()) {
+      numberOfUpdated++;
+    }
+  }
+  return numberOfUpdated;
+}
+
+
+size_t vtkMRMLROS2NodeNode::PublishObservedNodes(void)
+{
+  size_t numberOfPublished = 0;
+  const int nbPublisherRefs = this->GetNumberOfNodeReferences("publisher");
+  for (int i = 0; i < nbPublisherRefs; i ++) {
+    vtkMRMLROS2PublisherNode * publisherNode = vtkMRMLROS2PublisherNode::SafeDownCast(this->GetNthNodeReference("publisher", i));
+    if ((publisherNode != nullptr) && publisherNode->AutoPublish()) {
+      numberOfPublished++;
+    }
+  }
+  return numberOfPublished;
+}
+
+
+bool vtkMRMLROS2NodeNode::SpinPriorityNodes(void)
+{
+  if (!rclcpp::ok()) {
     mSpinning = false;
+    return false;
+  }
+  mSpinning = true;
+  // tf2 lookups / buffer
+  SpinTf2Buffer();
+  // parameters
+  for (auto & node : this->mParameterNodes) {
+    if (node != nullptr) {
+      vtkMRMLROS2Tracer::Scope trace("parameter", "Spin", node->GetName() ? node->GetName() : "");
+      const double start = vtkMRMLROS2TimeStatistics::Now();
+      node->Spin();
+      node->mSpinStatistics->AddSample(vtkMRMLROS2TimeStatistics::Now() - start);
+    }
+  }
+  return true;
+}
+
+
+void vtkMRMLROS2NodeNode::SpinMRML(void)
+{
+  vtkMRMLROS2Tracer::Scope trace("node", "SpinMRML", mROS2NodeName);
+  const double start = vtkMRMLROS2TimeStatistics::Now();
+  if (SpinPriorityNodes() && mSpinInBackground) {
+    // subscribers callbacks are executed in the background thread
+    SpinBackgroundSubscribers(std::chrono::steady_clock::time_point::max());
+  }
+  mSpinStatistics->AddSample(vtkMRMLROS2TimeStatistics::Now() - start);
+}
+
+
+bool vtkMRMLROS2NodeNode::RequiresPolling(void)
+{
+  if (!mInternals || !mInternals->mNodePointer) {
+    return false;
+  }
+  if (!mParameterNodes.empty()
+      || (this->GetNumberOfNodeReferences("lookup") != 0)) {
+    return true;
+  }
+  // observed nodes waiting for the auto publish rate
+  const int nbPublisherRefs = this->GetNumberOfNodeReferences("publisher");
+  for (int i = 0; i < nbPublisherRefs; i ++) {
+    vtkMRMLROS2PublisherNode * publisherNode = vtkMRMLROS2PublisherNode::SafeDownCast(this->GetNthNodeReference("publisher", i));
+    if ((publisherNode != nullptr) && publisherNode->GetAutoPublishPending()) {
+      return true;
+    }
   }
+  // anything left to the logic's executor, i.e. subscribers not
+  // handled in background but also services, timers and clients.
+  // The parameter services are in the background callback group.
+  return vtkMRMLROS2NodeInternals::HasForegroundEntities(mInternals->mNodePointer->get_node_base_interface(),
+                                                         mInternals->mBackgroundCallbackGroup);
 }
 
 
@@ -576,6 +773,8 @@ void vtkMRMLROS2NodeNode::WriteXML( ostream& of, int nIndent )
   Superclass::WriteXML(of, nIndent); // This will take care of referenced nodes
   vtkMRMLWriteXMLBeginMacro(of);
   vtkMRMLWriteXMLStdStringMacro(ROS2NodeName, ROS2NodeName);
+  vtkMRMLWriteXMLBooleanMacro(spinInBackground, SpinInBackground);
+  vtkMRMLWriteXMLBooleanMacro(intraProcess, IntraProcess);
   vtkMRMLWriteXMLEndMacro();
 }
 
@@ -586,10 +785,12 @@ void vtkMRMLROS2NodeNode::ReadXMLAttributes(const char** atts)
   Superclass::ReadXMLAttributes(atts); // This will take care of referenced nodes
   vtkMRMLReadXMLBeginMacro(atts);
   vtkMRMLReadXMLStdStringMacro(ROS2NodeName, ROS2NodeName);
+  vtkMRMLReadXMLBooleanMacro(spinInBackground, SpinInBackground);
+  vtkMRMLReadXMLBooleanMacro(intraProcess, IntraProcess);
   vtkMRMLReadXMLEndMacro();
   this->EndModify(wasModifying);
 
   // This is created before UpdateScene() for all other nodes is called.
   // It handles cases where Publishers and Subscribers are read before the ROS2Node
-  this->Create(mROS2NodeName);
+  this->Create(mROS2NodeName, mSpinInBackground, mIntraProcess);
 }
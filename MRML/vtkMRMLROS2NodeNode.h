@@ -5,12 +5,17 @@
 #include <vtkMRMLNode.h>
 
 #include <vtkSlicerROS2ModuleMRMLExport.h>
+#include <vtkMRMLROS2TimeStatistics.h>
+
+#include <chrono>
 
 // forward declarations
 class vtkMatrix4x4;
 class vtkMRMLROS2NodeInternals;
 class vtkMRMLROS2SubscriberNode;
+class vtkMRMLROS2GenericSubscriberNode;
 class vtkMRMLROS2PublisherNode;
+class vtkMRMLROS2GenericPublisherNode;
 class vtkMRMLROS2ParameterNode;
 class vtkMRMLROS2Tf2BroadcasterNode;
 class vtkMRMLROS2Tf2LookupNode;
@@ -21,11 +26,13 @@ class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2NodeNode: public vtkMRMLNode
 
   template <typename _ros_type, typename _slicer_type> friend class vtkMRMLROS2SubscriberTemplatedInternals;
   template <typename _slicer_type, typename _ros_type> friend class vtkMRMLROS2PublisherTemplatedInternals;
+  friend class vtkMRMLROS2GenericPublisherInternals;
   friend class vtkMRMLROS2ParameterInternals;
   friend class vtkMRMLROS2ParameterNode;
   friend class vtkMRMLROS2Tf2BroadcasterNode;
   friend class vtkMRMLROS2Tf2LookupNode;
   friend class vtkMRMLROS2RobotNode;
+  friend class vtkSlicerROS2Logic;
 
  public:
   typedef vtkMRMLROS2NodeNode SelfType;
@@ -38,8 +45,16 @@ class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2NodeNode: public vtkMRMLNode
   std::vector<std::string> mRobotNames;
 
   /*! Calls rclcpp::init if needed and then create the internal ROS
-    node. */
-  void Create(const std::string & nodeName);
+    node.  If spinInBackground is set, the subscribers callbacks are
+    executed by a dedicated executor thread and the latest messages
+    are handed to the MRML nodes when Spin is called.  If intraProcess
+    is set, messages exchanged with other ROS nodes created in Slicer
+    with intraProcess set are passed by pointer instead of being
+    serialized (see rclcpp intra-process communications).  The ROS
+    parameter services of the node are always executed by a dedicated
+    thread so the node doesn't need to be polled for them. */
+  void Create(const std::string & nodeName, const bool & spinInBackground = false,
+              const bool & intraProcess = false);
   void Destroy(void); // THIS IS KILLING SLICER
   inline const std::string GetROS2NodeName(void) const {
     return mROS2NodeName;
@@ -52,6 +67,12 @@ class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2NodeNode: public vtkMRMLNode
     new subscriber was not created. */
   vtkMRMLROS2SubscriberNode * CreateAndAddSubscriberNode(const char * className, const std::string & topic);
 
+  /*! Helper method to create a subscriber for a message type only
+    known at runtime, e.g. "geometry_msgs/msg/PoseStamped".  See
+    vtkMRMLROS2GenericSubscriberNode.  It will return a nullptr if
+    the subscriber was not created. */
+  vtkMRMLROS2GenericSubscriberNode * CreateAndAddGenericSubscriberNode(const std::string & rosType, const std::string & topic);
+
   /*! Helper method to create a publisher given a publisher type and
     a topic. This method will create the corresponding MRML node if
     there is no existing publisher for the given topic and add it to
@@ -59,6 +80,12 @@ class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2NodeNode: public vtkMRMLNode
     new publisher was not created. */
   vtkMRMLROS2PublisherNode * CreateAndAddPublisherNode(const char * className, const std::string & topic);
 
+  /*! Helper method to create a publisher for a message type only
+    known at runtime, e.g. "geometry_msgs/msg/PoseStamped".  See
+    vtkMRMLROS2GenericPublisherNode.  It will return a nullptr if
+    the publisher was not created. */
+  vtkMRMLROS2GenericPublisherNode * CreateAndAddGenericPublisherNode(const std::string & rosType, const std::string & topic);
+
   /*! Helper method to create a parameter node.  You need to provide
     the name of the ROS node that holds the parameters you want to
     monitor. */
@@ -92,10 +119,69 @@ class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2NodeNode: public vtkMRMLNode
   bool RemoveAndDeleteTf2BroadcasterNode(const std::string & parent_id, const std::string & child_id);
   bool RemoveAndDeleteRobotNode(const std::string & robotName);
 
+  /*! Spin the ROS node using rclcpp::spin_some and then update the
+    MRML nodes (see SpinMRML).  This is only needed if the ROS node is
+    not spun by the module's logic.  If the ROS node has already been
+    added to an executor, e.g. by the module's logic, its callbacks
+    are left to that executor and only the MRML nodes are updated. */
   void Spin(void);
+
+  /*! Update all the MRML nodes attached to this ROS node (messages
+    received in background, parameters and tf2 lookups).  This doesn't
+    execute the ROS callbacks, the module's logic uses a single
+    executor for all ROS nodes and then calls SpinMRML for each ROS
+    node. */
+  void SpinMRML(void);
+
+  /*! Invoke the Modified event for all subscribers coalescing their
+    Modified events (see
+    vtkMRMLROS2SubscriberNode::SetCoalesceModifiedEvents) that
+    received messages since the last call.  Called at the end of each
+    spin by the module's logic and by Spin. */
+  void FlushModifiedEvents(void);
+
+  /*! Update the MRML nodes driven by subscribers (see
+    vtkMRMLROS2SubscriberNode::DriveNode) that received messages since
+    the last call.  Called at the end of each spin by the module's
+    logic and by Spin.  Returns the number of nodes updated. */
+  size_t UpdateDrivenNodes(void);
+
+  /*! Publish the MRML nodes observed by publishers (see
+    vtkMRMLROS2PublisherNode::ObserveNode) modified since the last
+    call.  Called at the end of each spin by the module's logic and by
+    Spin.  Returns the number of nodes published. */
+  size_t PublishObservedNodes(void);
+
   inline bool GetSpinning(void) const {
     return mSpinning;
   }
+  inline bool GetSpinInBackground(void) const {
+    return mSpinInBackground;
+  }
+  inline bool GetIntraProcess(void) const {
+    return mIntraProcess;
+  }
+
+  /*! Returns true if this node needs to be spun periodically, i.e. it
+    has parameters, tf2 lookups, observed nodes waiting to be
+    published or any callback not handled by a background thread
+    (subscribers, services including the ROS parameter services,
+    timers, clients...).  Nodes with all their callbacks in background
+    only need to be spun when the background thread signals new
+    messages (see vtkMRMLROS2::GetWakeupFileDescriptor). */
+  bool RequiresPolling(void);
+
+  /*! Time spent updating the MRML nodes attached to this ROS node
+    for each spin (see SpinMRML), excluding the ROS callbacks. */
+  inline vtkMRMLROS2TimeStatistics * GetSpinStatistics(void) {
+    return mSpinStatistics;
+  }
+
+  /*! Time spent in SpinTf2Buffer, i.e. looking up all the tf2
+    transforms. */
+  inline vtkMRMLROS2TimeStatistics * GetTf2BufferStatistics(void) {
+    return mTf2BufferStatistics;
+  }
   void WarnIfNotSpinning(const std::string & contextMessage) const;
 
   // Save and load
@@ -113,16 +199,39 @@ class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2NodeNode: public vtkMRMLNode
 
   std::vector<vtkMRMLROS2ParameterNode* > mParameterNodes;
   bool mSpinning = false;
+  bool mSpinInBackground = false;
+  bool mIntraProcess = false;
+
+  /*! Update the high priority nodes, i.e. tf2 lookups (including
+    robot links) and parameters.  Returns false if ROS is not
+    running. */
+  bool SpinPriorityNodes(void);
+
+  /*! Move the latest messages received by the background executor
+    to the subscriber nodes.  Stops when the deadline is reached and
+    returns false if some subscribers have not been updated.  At least
+    one subscriber is updated, even if the deadline is already reached.
+    The next call starts with the first subscriber not updated. */
+  bool SpinBackgroundSubscribers(const std::chrono::steady_clock::time_point & deadline);
+  int mNextBackgroundSubscriber = 0;
 
   /*! Creates the tf2 buffer if needed, return true if created. */
   bool SetTf2Buffer(void);
   void SpinTf2Buffer(void);
   vtkSmartPointer<vtkMatrix4x4> mTemporaryMatrix;
+  vtkSmartPointer<vtkMRMLROS2TimeStatistics> mSpinStatistics;
+  vtkSmartPointer<vtkMRMLROS2TimeStatistics> mTf2BufferStatistics;
 
   // For ReadXMLAttributes
   inline void SetROS2NodeName(const std::string & name) {
     mROS2NodeName = name;
   }
+  inline void SetSpinInBackground(const bool & background) {
+    mSpinInBackground = background;
+  }
+  inline void SetIntraProcess(const bool & intraProcess) {
+    mIntraProcess = intraProcess;
+  }
 };
 
 #endif // __vtkMRMLROS2NodeNode_h
@@ -114,6 +114,7 @@ protected:
 
   // A callback function that is called when the parameter server responds to the request for parameters.
   void GetParametersCallback(std::shared_future<std::vector<rclcpp::Parameter>> future) {
+    const double start = vtkMRMLROS2TimeStatistics::Now();
     try {
       auto result = future.get();
       for (const auto &param : result) {
@@ -123,10 +124,12 @@ protected:
     } catch (std::exception &e) {
       std::cerr << "Exception: " << e.what() << std::endl;
     }
+    mMRMLNode->mCallbackStatistics->AddSample(vtkMRMLROS2TimeStatistics::Now() - start);
   }
 
   // A callback function that is called when the parameter server responds to the request for parameters.
   void ParameterEventCallback(const rcl_interfaces::msg::ParameterEvent::SharedPtr event) {
+    const double start = vtkMRMLROS2TimeStatistics::Now();
     // Iterate over the new parameters
     for (const auto &new_param : event->new_parameters) {
       // rclcpp::Parameter param(new_param);
@@ -143,6 +146,7 @@ protected:
     for (const auto &deleted_param : event->deleted_parameters) {
       mParameterStore.erase(deleted_param.name);
     }
+    mMRMLNode->mCallbackStatistics->AddSample(vtkMRMLROS2TimeStatistics::Now() - start);
   }
 
 
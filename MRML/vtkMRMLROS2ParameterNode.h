@@ -4,7 +4,9 @@
 // MRML includes
 #include <vtkMRMLNode.h>
 #include <vtkCommand.h>
+#include <vtkSmartPointer.h>
 #include <vtkSlicerROS2ModuleMRMLExport.h>
+#include <vtkMRMLROS2TimeStatistics.h>
 #include <memory> //for shared_ptr
 
 // forward declaration for internals
@@ -38,6 +40,18 @@ class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2ParameterNode : public vtkMR
 
     bool Spin(void);
 
+    /*! Time spent in Spin. */
+    inline vtkMRMLROS2TimeStatistics * GetSpinStatistics(void) {
+      return mSpinStatistics;
+    }
+
+    /*! Time spent handling the parameter server responses and
+      parameter events, including the ParameterModifiedEvent
+      observers. */
+    inline vtkMRMLROS2TimeStatistics * GetCallbackStatistics(void) {
+      return mCallbackStatistics;
+    }
+
     /*! Get the name of the node holding the parameters we're looking for. */
     inline const std::string & GetMonitoredNodeName(void) const {
       return mMonitoredNodeName;
@@ -169,6 +183,8 @@ class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2ParameterNode : public vtkMR
     std::string mMRMLNodeName = "ros2:param:undefined";
     std::string mMonitoredNodeName = "undefined";
     bool mIsParameterServerReady = false;
+    vtkSmartPointer<vtkMRMLROS2TimeStatistics> mSpinStatistics = vtkSmartPointer<vtkMRMLROS2TimeStatistics>::New();
+    vtkSmartPointer<vtkMRMLROS2TimeStatistics> mCallbackStatistics = vtkSmartPointer<vtkMRMLROS2TimeStatistics>::New();
 
     // For ReadXMLAttributes
     vtkGetMacro(mMRMLNodeName, std::string);
@@ -12,8 +12,11 @@ VTK_MRML_ROS_PUBLISHER_VTK_CXX(vtkIntArray, std_msgs::msg::Int64MultiArray, IntA
 VTK_MRML_ROS_PUBLISHER_VTK_CXX(vtkDoubleArray, std_msgs::msg::Float64MultiArray, DoubleArray);
 VTK_MRML_ROS_PUBLISHER_VTK_CXX(vtkTable, std_msgs::msg::Int64MultiArray, IntTable);
 VTK_MRML_ROS_PUBLISHER_VTK_CXX(vtkTable, std_msgs::msg::Float64MultiArray, DoubleTable);
+VTK_MRML_ROS_PUBLISHER_VTK_CXX(vtkImageData, std_msgs::msg::Int64MultiArray, IntTensor);
+VTK_MRML_ROS_PUBLISHER_VTK_CXX(vtkImageData, std_msgs::msg::Float64MultiArray, DoubleTensor);
 
 VTK_MRML_ROS_PUBLISHER_VTK_CXX(vtkMatrix4x4, geometry_msgs::msg::PoseStamped, PoseStamped);
 VTK_MRML_ROS_PUBLISHER_VTK_CXX(vtkDoubleArray, geometry_msgs::msg::WrenchStamped, WrenchStamped);
 VTK_MRML_ROS_PUBLISHER_VTK_CXX(vtkTransformCollection, geometry_msgs::msg::PoseArray, PoseArray);
 VTK_MRML_ROS_PUBLISHER_VTK_CXX(vtkTypeUInt8Array, sensor_msgs::msg::Image, UInt8Image);
+VTK_MRML_ROS_PUBLISHER_VTK_CXX(vtkImageData, sensor_msgs::msg::Image, Image);
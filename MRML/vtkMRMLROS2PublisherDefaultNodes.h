@@ -12,15 +12,19 @@ VTK_MRML_ROS_PUBLISHER_NATIVE_H(double, Double);
 #include <vtkMatrix4x4.h>
 #include <vtkTransformCollection.h>
 #include <vtkTable.h>
+#include <vtkImageData.h>
 #include <vtkTypeUInt8Array.h>
 
 VTK_MRML_ROS_PUBLISHER_VTK_H(vtkIntArray, IntArray);
 VTK_MRML_ROS_PUBLISHER_VTK_H(vtkDoubleArray, DoubleArray);
 VTK_MRML_ROS_PUBLISHER_VTK_H(vtkTable, IntTable);
 VTK_MRML_ROS_PUBLISHER_VTK_H(vtkTable, DoubleTable);
+VTK_MRML_ROS_PUBLISHER_VTK_H(vtkImageData, IntTensor);
+VTK_MRML_ROS_PUBLISHER_VTK_H(vtkImageData, DoubleTensor);
 VTK_MRML_ROS_PUBLISHER_VTK_H(vtkMatrix4x4, PoseStamped);
 VTK_MRML_ROS_PUBLISHER_VTK_H(vtkDoubleArray, WrenchStamped);
 VTK_MRML_ROS_PUBLISHER_VTK_H(vtkTransformCollection, PoseArray);
 VTK_MRML_ROS_PUBLISHER_VTK_H(vtkTypeUInt8Array, UInt8Image);
+VTK_MRML_ROS_PUBLISHER_VTK_H(vtkImageData, Image);
 
 #endif // __vtkMRMLROS2PublisherDefaultsNodes_h
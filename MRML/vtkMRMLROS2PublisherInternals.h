@@ -1,13 +1,31 @@
 #ifndef __vtkMRMLROS2PublisherInternals_h
 #define __vtkMRMLROS2PublisherInternals_h
 
+#include <type_traits>
+
 // ROS2 includes
 #include <rclcpp/rclcpp.hpp>
 
+#include <vtkSmartPointer.h>
 #include <vtkMRMLScene.h>
 #include <vtkMRMLROS2Utils.h>
 #include <vtkMRMLROS2NodeNode.h>
 #include <vtkMRMLROS2NodeInternals.h>
+#include <vtkMRMLROS2PublisherQueue.h>
+#include <vtkMRMLToSlicer.h>
+
+/*! Copy of the Slicer data used by asynchronous publishers, so the
+  caller can modify its object while the copy is converted and
+  published by the worker thread.  Overload this for types which don't
+  support DeepCopy. */
+template <typename _slicer_type>
+void vtkMRMLROS2Snapshot(_slicer_type * input, vtkSmartPointer<_slicer_type> & result)
+{
+  if (!result) {
+    result = vtkSmartPointer<_slicer_type>::New();
+  }
+  result->DeepCopy(input);
+}
 
 class vtkMRMLROS2PublisherInternals
 {
@@ -24,6 +42,18 @@ public:
   virtual bool IsAddedToROS2Node(void) const = 0;
   virtual const char * GetROSType(void) const = 0;
   virtual const char * GetSlicerType(void) const = 0;
+  virtual size_t GetQueueSize(void) const {
+    return 0;
+  }
+  virtual size_t GetNumberOfDroppedMessages(void) const {
+    return 0;
+  }
+  /*! Convert the MRML node to the Slicer type and publish it. */
+  virtual bool PublishMRMLNode(vtkMRMLNode * vtkNotUsed(node), size_t & vtkNotUsed(numberOfSubscribers),
+                               std::string & errorMessage) {
+    errorMessage = "publishing MRML nodes is not supported for this publisher";
+    return false;
+  }
 protected:
   vtkMRMLROS2PublisherNode * mMRMLNode;
   std::shared_ptr<rclcpp::Node> mROSNode = nullptr;
@@ -44,6 +74,120 @@ public:
 protected:
   std::shared_ptr<rclcpp::Publisher<_ros_type>> mPublisher = nullptr;
 
+  /**
+   * Message reused for each call to Publish when the message is
+   * serialized by the middleware.  Conversions resize the message
+   * buffers only if the size changed.
+   */
+  _ros_type mMessage;
+  bool mIntraProcess = false;
+
+  /**
+   * Queue used in asynchronous mode, VTK objects are queued by
+   * pointer to a snapshot and native types by value.  The worker
+   * thread converts and publishes each item.  Declared last so the
+   * worker thread is stopped before the publisher is destroyed.
+   */
+  static constexpr bool IsVTKType = std::is_base_of<vtkObjectBase, _slicer_type>::value;
+  typedef typename std::conditional<IsVTKType,
+                                    vtkSmartPointer<_slicer_type>,
+                                    _slicer_type>::type QueueItemType;
+  bool mAsynchronous = false;
+  vtkMRMLROS2PublisherQueue<QueueItemType> mQueue;
+
+  void PublishQueueItem(QueueItemType & item)
+  {
+    if constexpr (IsVTKType) {
+      ConvertAndPublish<_slicer_type *>(item.GetPointer());
+    } else {
+      ConvertAndPublish<const _slicer_type &>(item);
+    }
+  }
+
+  /**
+   * Push an item in the queue, returns the number of subscribers at
+   * the time the message is queued or 0 if it was dropped.
+   */
+  size_t Enqueue(QueueItemType && item, const size_t & nbSubscriber)
+  {
+    if (!mQueue.Push(std::move(item))) {
+      return 0;
+    }
+    return nbSubscriber;
+  }
+
+  void StartQueue(void)
+  {
+    mAsynchronous = mMRMLNode->mAsynchronous;
+    if (!mAsynchronous) {
+      return;
+    }
+    typename vtkMRMLROS2PublisherQueue<QueueItemType>::PolicyType policy;
+    if (mMRMLNode->mQueueOverflowPolicy == "drop_newest") {
+      policy = vtkMRMLROS2PublisherQueue<QueueItemType>::DropNewest;
+    } else if (mMRMLNode->mQueueOverflowPolicy == "block") {
+      policy = vtkMRMLROS2PublisherQueue<QueueItemType>::Block;
+    } else {
+      policy = vtkMRMLROS2PublisherQueue<QueueItemType>::DropOldest;
+    }
+    mQueue.Start(mMRMLNode->mQueueDepth, policy,
+                 [this](QueueItemType & item) {
+                   PublishQueueItem(item);
+                 });
+  }
+
+public:
+  size_t GetQueueSize(void) const override
+  {
+    return mQueue.GetSize();
+  }
+
+  size_t GetNumberOfDroppedMessages(void) const override
+  {
+    return mQueue.GetNumberOfDroppedItems();
+  }
+
+protected:
+
+  /**
+   * Convert the Slicer object and publish it.  If the middleware can
+   * loan messages, the conversion writes directly in the middleware
+   * buffer.  For intra-process communications, a new message is
+   * created so rclcpp can pass ownership to the subscribers without
+   * copy.  Otherwise the persistent message is reused.  Messages for
+   * which the conversion failed are not published and 0 is returned.
+   */
+  template <typename _input_type>
+  size_t ConvertAndPublish(_input_type input)
+  {
+    const auto nbSubscriber = mPublisher->get_subscription_count();
+    if (nbSubscriber == 0) {
+      return 0;
+    }
+    if (mPublisher->can_loan_messages()) {
+      auto loanedMessage = mPublisher->borrow_loaned_message();
+      vtkSlicerToROS2(input, loanedMessage.get(), mROSNode);
+      if (!vtkSlicerToROS2IsValid(loanedMessage.get())) {
+        return 0; // the loan is returned when loanedMessage is destroyed
+      }
+      mPublisher->publish(std::move(loanedMessage));
+    } else if (mIntraProcess) {
+      auto rosMessage = std::make_unique<_ros_type>();
+      vtkSlicerToROS2(input, *rosMessage, mROSNode);
+      if (!vtkSlicerToROS2IsValid(*rosMessage)) {
+        return 0;
+      }
+      mPublisher->publish(std::move(rosMessage));
+    } else {
+      vtkSlicerToROS2(input, mMessage, mROSNode);
+      if (!vtkSlicerToROS2IsValid(mMessage)) {
+        return 0;
+      }
+      mPublisher->publish(mMessage);
+    }
+    return nbSubscriber;
+  }
+
   /**
    * Add the Publisher to the ROS2 node.  This methods searched the
    * vtkMRMLROS2NodeNode by Id to locate the rclcpp::node
@@ -61,7 +205,15 @@ protected:
       return false;
     }
     mROSNode = mrmlROSNodePtr->mInternals->mNodePointer;
-    mPublisher = mROSNode->create_publisher<_ros_type>(topic, 10);
+    rclcpp::PublisherOptions options;
+    mIntraProcess = mrmlROSNodePtr->GetIntraProcess();
+    if (mIntraProcess
+        && !vtkMRMLROS2::QoSAllowsIntraProcess(mMRMLNode->mQoS)) {
+      options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+      mIntraProcess = false;
+    }
+    mPublisher = mROSNode->create_publisher<_ros_type>(topic, vtkMRMLROS2::ToROS2QoS(mMRMLNode->mQoS), options);
+    StartQueue();
     mrmlROSNodePtr->SetNthNodeReferenceID("publisher",
                                           mrmlROSNodePtr->GetNumberOfNodeReferences("publisher"),
                                           mMRMLNode->GetID());
@@ -86,6 +238,7 @@ protected:
     rosNodePtr->RemoveNthNodeReferenceID("publisher",
                                          rosNodePtr->GetNumberOfNodeReferences("publisher"));
 
+    mQueue.Stop();
     mPublisher.reset();
     mROSNode.reset();
 
@@ -125,13 +278,24 @@ public:
 
   size_t Publish(const _slicer_type & message)
   {
+    if (!this->mAsynchronous) {
+      return this->template ConvertAndPublish<const _slicer_type &>(message);
+    }
     const auto nbSubscriber = this->mPublisher->get_subscription_count();
-    if (nbSubscriber != 0) {
-      _ros_type rosMessage;
-      vtkSlicerToROS2(message, rosMessage, BaseType::mROSNode);
-      this->mPublisher->publish(rosMessage);
+    if (nbSubscriber == 0) {
+      return 0;
     }
-    return nbSubscriber;
+    return this->Enqueue(_slicer_type(message), nbSubscriber);
+  }
+
+  bool PublishMRMLNode(vtkMRMLNode * node, size_t & numberOfSubscribers,
+                       std::string & errorMessage) override
+  {
+    if (!vtkMRMLToSlicer(node, mLastMessageSlicer, errorMessage)) {
+      return false;
+    }
+    numberOfSubscribers = Publish(mLastMessageSlicer);
+    return true;
   }
 };
 
@@ -154,13 +318,26 @@ public:
 
   size_t Publish(_slicer_type * message)
   {
+    if (!this->mAsynchronous) {
+      return this->template ConvertAndPublish<_slicer_type *>(message);
+    }
     const auto nbSubscriber = this->mPublisher->get_subscription_count();
-    if (nbSubscriber != 0) {
-      _ros_type rosMessage;
-      vtkSlicerToROS2(message, rosMessage, BaseType::mROSNode);
-      this->mPublisher->publish(rosMessage);
+    if (nbSubscriber == 0) {
+      return 0;
     }
-    return nbSubscriber;
+    vtkSmartPointer<_slicer_type> snapshot;
+    vtkMRMLROS2Snapshot(message, snapshot);
+    return this->Enqueue(std::move(snapshot), nbSubscriber);
+  }
+
+  bool PublishMRMLNode(vtkMRMLNode * node, size_t & numberOfSubscribers,
+                       std::string & errorMessage) override
+  {
+    if (!vtkMRMLToSlicer(node, mLastMessageSlicer.GetPointer(), errorMessage)) {
+      return false;
+    }
+    numberOfSubscribers = Publish(mLastMessageSlicer);
+    return true;
   }
 };
 
@@ -1,6 +1,24 @@
 #include <vtkMRMLROS2PublisherNode.h>
 
 #include <vtkMRMLROS2PublisherInternals.h>
+#include <vtkMRMLROS2TimeStatistics.h>
+#include <vtkMRMLROS2Tracer.h>
+
+#include <vtkIntArray.h>
+#include <vtkNew.h>
+#include <vtkMRMLTransformableNode.h>
+#include <vtkMRMLVolumeNode.h>
+
+
+vtkMRMLROS2PublisherNode::vtkMRMLROS2PublisherNode()
+{
+  // events used to trigger the auto publish, restored when the scene is loaded
+  vtkNew<vtkIntArray> events;
+  events->InsertNextValue(vtkCommand::ModifiedEvent);
+  events->InsertNextValue(vtkMRMLTransformableNode::TransformModifiedEvent);
+  events->InsertNextValue(vtkMRMLVolumeNode::ImageDataModifiedEvent);
+  this->AddNodeReferenceRole("observed", nullptr, events);
+}
 
 
 void vtkMRMLROS2PublisherNode::PrintSelf(std::ostream& os, vtkIndent indent)
@@ -11,6 +29,15 @@ void vtkMRMLROS2PublisherNode::PrintSelf(std::ostream& os, vtkIndent indent)
   os << indent << "Slicer type: " << mInternals->GetSlicerType() << "\n"; // This is scrambled
   os << indent << "Number of calls: " << mNumberOfCalls << "\n";
   os << indent << "Number of messages sent:" << mNumberOfMessagesSent << "\n";
+  os << indent << "Observed node: " << (this->GetNodeReferenceID("observed") ? this->GetNodeReferenceID("observed") : "none") << "\n";
+  os << indent << "Auto publish rate: " << mAutoPublishRate << "\n";
+  os << indent << "Asynchronous: " << (mAsynchronous ? "true" : "false") << "\n";
+  if (mAsynchronous) {
+    os << indent << "Queue depth: " << mQueueDepth << "\n";
+    os << indent << "Queue overflow policy: " << mQueueOverflowPolicy << "\n";
+    os << indent << "Queue size: " << GetQueueSize() << "\n";
+    os << indent << "Number of dropped messages: " << GetNumberOfDroppedMessages() << "\n";
+  }
 }
 
 
@@ -64,11 +91,235 @@ const char * vtkMRMLROS2PublisherNode::GetSlicerType(void) const
 }
 
 
+bool vtkMRMLROS2PublisherNode::SetQoSHistory(const std::string & history)
+{
+  vtkMRMLROS2::QoSSettings qos = mQoS;
+  qos.History = history;
+  return SetQoS(qos, "SetQoSHistory");
+}
+
+
+bool vtkMRMLROS2PublisherNode::SetQoSDepth(const int & depth)
+{
+  vtkMRMLROS2::QoSSettings qos = mQoS;
+  qos.Depth = depth;
+  return SetQoS(qos, "SetQoSDepth");
+}
+
+
+bool vtkMRMLROS2PublisherNode::SetQoSReliability(const std::string & reliability)
+{
+  vtkMRMLROS2::QoSSettings qos = mQoS;
+  qos.Reliability = reliability;
+  return SetQoS(qos, "SetQoSReliability");
+}
+
+
+bool vtkMRMLROS2PublisherNode::SetQoSDurability(const std::string & durability)
+{
+  vtkMRMLROS2::QoSSettings qos = mQoS;
+  qos.Durability = durability;
+  return SetQoS(qos, "SetQoSDurability");
+}
+
+
+bool vtkMRMLROS2PublisherNode::SetQoSDeadline(const double & seconds)
+{
+  vtkMRMLROS2::QoSSettings qos = mQoS;
+  qos.Deadline = seconds;
+  return SetQoS(qos, "SetQoSDeadline");
+}
+
+
+bool vtkMRMLROS2PublisherNode::SetQoSLifespan(const double & seconds)
+{
+  vtkMRMLROS2::QoSSettings qos = mQoS;
+  qos.Lifespan = seconds;
+  return SetQoS(qos, "SetQoSLifespan");
+}
+
+
+bool vtkMRMLROS2PublisherNode::SetQoS(const vtkMRMLROS2::QoSSettings & qos, const char * context)
+{
+  if (IsAddedToROS2Node()) {
+    vtkErrorMacro(<< context << ": QoS must be set before the publisher for topic \"" << mTopic << "\" is added to the ROS node");
+    return false;
+  }
+  std::string errorMessage;
+  if (!vtkMRMLROS2::CheckQoSSettings(qos, errorMessage)) {
+    vtkErrorMacro(<< context << ": " << errorMessage);
+    return false;
+  }
+  mQoS = qos;
+  return true;
+}
+
+
+bool vtkMRMLROS2PublisherNode::CheckNotAdded(const char * context)
+{
+  if (IsAddedToROS2Node()) {
+    vtkErrorMacro(<< context << ": must be set before the publisher for topic \"" << mTopic << "\" is added to the ROS node");
+    return false;
+  }
+  return true;
+}
+
+
+bool vtkMRMLROS2PublisherNode::SetAsynchronous(const bool & asynchronous)
+{
+  if (!CheckNotAdded("SetAsynchronous")) {
+    return false;
+  }
+  mAsynchronous = asynchronous;
+  return true;
+}
+
+
+bool vtkMRMLROS2PublisherNode::SetQueueDepth(const int & depth)
+{
+  if (!CheckNotAdded("SetQueueDepth")) {
+    return false;
+  }
+  if (depth < 1) {
+    vtkErrorMacro(<< "SetQueueDepth: invalid depth " << depth << ", must be at least 1");
+    return false;
+  }
+  mQueueDepth = depth;
+  return true;
+}
+
+
+bool vtkMRMLROS2PublisherNode::SetQueueOverflowPolicy(const std::string & policy)
+{
+  if (!CheckNotAdded("SetQueueOverflowPolicy")) {
+    return false;
+  }
+  if ((policy != "drop_oldest") && (policy != "drop_newest") && (policy != "block")) {
+    vtkErrorMacro(<< "SetQueueOverflowPolicy: invalid policy \"" << policy << "\", must be \"drop_oldest\", \"drop_newest\" or \"block\"");
+    return false;
+  }
+  mQueueOverflowPolicy = policy;
+  return true;
+}
+
+
+size_t vtkMRMLROS2PublisherNode::GetQueueSize(void) const
+{
+  return mInternals->GetQueueSize();
+}
+
+
+size_t vtkMRMLROS2PublisherNode::GetNumberOfDroppedMessages(void) const
+{
+  return mInternals->GetNumberOfDroppedMessages();
+}
+
+
+bool vtkMRMLROS2PublisherNode::ObserveNode(vtkMRMLNode * node)
+{
+  if (node == nullptr) {
+    this->SetAndObserveNodeReferenceID("observed", nullptr);
+    mAutoPublishPending = false;
+    return true;
+  }
+  if (!this->GetScene() || (this->GetScene()->GetNodeByID(node->GetID()) != node)) {
+    vtkErrorMacro(<< "ObserveNode: node must be in the same scene as the publisher for topic \"" << mTopic << "\"");
+    return false;
+  }
+  this->SetAndObserveNodeReferenceID("observed", node->GetID());
+  // publish the current state on the next spin
+  mAutoPublishPending = true;
+  vtkMRMLROS2::NotifyWakeup();
+  return true;
+}
+
+
+vtkMRMLNode * vtkMRMLROS2PublisherNode::GetObservedNode(void)
+{
+  return this->GetNodeReference("observed");
+}
+
+
+bool vtkMRMLROS2PublisherNode::SetAutoPublishRate(const double & rate)
+{
+  if (rate < 0.0) {
+    vtkErrorMacro(<< "SetAutoPublishRate: rate can't be negative, use 0 for no limit");
+    return false;
+  }
+  mAutoPublishRate = rate;
+  return true;
+}
+
+
+bool vtkMRMLROS2PublisherNode::PublishObservedNode(void)
+{
+  vtkMRMLNode * node = GetObservedNode();
+  if (node == nullptr) {
+    vtkErrorMacro(<< "PublishObservedNode: publisher for topic \"" << mTopic << "\" doesn't observe any node");
+    return false;
+  }
+  if (!IsAddedToROS2Node()) {
+    vtkErrorMacro(<< "PublishObservedNode: publisher for topic \"" << mTopic << "\" is not added to a ROS node");
+    return false;
+  }
+  vtkMRMLROS2Tracer::Scope trace("publisher", "PublishObservedNode", mTopic);
+  mAutoPublishPending = false;
+  mNumberOfCalls++;
+  size_t justSent = 0;
+  std::string errorMessage;
+  if (!mInternals->PublishMRMLNode(node, justSent, errorMessage)) {
+    vtkErrorMacro(<< "PublishObservedNode: " << errorMessage);
+    return false;
+  }
+  mNumberOfMessagesSent += justSent;
+  return true;
+}
+
+
+bool vtkMRMLROS2PublisherNode::AutoPublish(void)
+{
+  if (!mAutoPublishPending) {
+    return false;
+  }
+  const double now = vtkMRMLROS2TimeStatistics::Now();
+  if ((mAutoPublishRate > 0.0)
+      && ((now - mLastAutoPublishTime) < (1000.0 / mAutoPublishRate))) {
+    // still pending, will be published on a later spin
+    return false;
+  }
+  mLastAutoPublishTime = now;
+  return PublishObservedNode();
+}
+
+
+void vtkMRMLROS2PublisherNode::ProcessMRMLEvents(vtkObject * caller, unsigned long event, void * callData)
+{
+  Superclass::ProcessMRMLEvents(caller, event, callData);
+  if ((caller != nullptr) && (caller == GetObservedNode())) {
+    if (!mAutoPublishPending) {
+      mAutoPublishPending = true;
+      // make sure the application spins even if no ROS node requires polling
+      vtkMRMLROS2::NotifyWakeup();
+    }
+  }
+}
+
+
 void vtkMRMLROS2PublisherNode::WriteXML(ostream& of, int nIndent)
 {
   Superclass::WriteXML(of, nIndent); // This will take care of referenced nodes
   vtkMRMLWriteXMLBeginMacro(of);
   vtkMRMLWriteXMLStdStringMacro(topicName, Topic);
+  vtkMRMLWriteXMLStdStringMacro(qosHistory, QoSHistory);
+  vtkMRMLWriteXMLIntMacro(qosDepth, QoSDepth);
+  vtkMRMLWriteXMLStdStringMacro(qosReliability, QoSReliability);
+  vtkMRMLWriteXMLStdStringMacro(qosDurability, QoSDurability);
+  vtkMRMLWriteXMLFloatMacro(qosDeadline, QoSDeadline);
+  vtkMRMLWriteXMLFloatMacro(qosLifespan, QoSLifespan);
+  vtkMRMLWriteXMLBooleanMacro(asynchronous, Asynchronous);
+  vtkMRMLWriteXMLIntMacro(queueDepth, QueueDepth);
+  vtkMRMLWriteXMLStdStringMacro(queueOverflowPolicy, QueueOverflowPolicy);
+  vtkMRMLWriteXMLFloatMacro(autoPublishRate, AutoPublishRate);
   vtkMRMLWriteXMLEndMacro();
 }
 
@@ -79,6 +330,16 @@ void vtkMRMLROS2PublisherNode::ReadXMLAttributes(const char** atts)
   Superclass::ReadXMLAttributes(atts); // This will take care of referenced nodes
   vtkMRMLReadXMLBeginMacro(atts);
   vtkMRMLReadXMLStdStringMacro(topicName, Topic);
+  vtkMRMLReadXMLStdStringMacro(qosHistory, QoSHistory);
+  vtkMRMLReadXMLIntMacro(qosDepth, QoSDepth);
+  vtkMRMLReadXMLStdStringMacro(qosReliability, QoSReliability);
+  vtkMRMLReadXMLStdStringMacro(qosDurability, QoSDurability);
+  vtkMRMLReadXMLFloatMacro(qosDeadline, QoSDeadline);
+  vtkMRMLReadXMLFloatMacro(qosLifespan, QoSLifespan);
+  vtkMRMLReadXMLBooleanMacro(asynchronous, Asynchronous);
+  vtkMRMLReadXMLIntMacro(queueDepth, QueueDepth);
+  vtkMRMLReadXMLStdStringMacro(queueOverflowPolicy, QueueOverflowPolicy);
+  vtkMRMLReadXMLFloatMacro(autoPublishRate, AutoPublishRate);
   vtkMRMLReadXMLEndMacro();
   this->EndModify(wasModifying);
 }
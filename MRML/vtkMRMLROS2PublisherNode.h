@@ -5,6 +5,7 @@
 #include <vtkMRMLNode.h>
 
 #include <vtkSlicerROS2ModuleMRMLExport.h>
+#include <vtkMRMLROS2Utils.h>
 
 // forward declaration for internals
 class vtkMRMLROS2PublisherInternals;
@@ -14,6 +15,8 @@ class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2PublisherNode: public vtkMRM
 
   // friend declarations
   friend class vtkMRMLROS2PublisherInternals;
+  friend class vtkMRMLROS2GenericPublisherInternals;
+  friend class vtkMRMLROS2NodeNode;
 
   template <typename _slicer_type, typename _ros_type>
     friend class vtkMRMLROS2PublisherTemplatedInternals;
@@ -45,13 +48,105 @@ class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2PublisherNode: public vtkMRM
 
   void PrintSelf(std::ostream& os, vtkIndent indent) override;
 
+  /*! QoS used when the publisher is added to a ROS node, so these
+    must be set before AddToROS2Node.  History is "keep_last"
+    (default) or "keep_all", depth is the queue size for keep_last,
+    reliability is "reliable" (default) or "best_effort", durability is
+    "volatile" (default) or "transient_local".  Deadline and lifespan
+    are in seconds, 0 (default) means infinite.  Setters return false
+    if the value is invalid or the publisher is already added. */
+  bool SetQoSHistory(const std::string & history);
+  inline const std::string & GetQoSHistory(void) const {
+    return mQoS.History;
+  }
+  bool SetQoSDepth(const int & depth);
+  inline int GetQoSDepth(void) const {
+    return mQoS.Depth;
+  }
+  bool SetQoSReliability(const std::string & reliability);
+  inline const std::string & GetQoSReliability(void) const {
+    return mQoS.Reliability;
+  }
+  bool SetQoSDurability(const std::string & durability);
+  inline const std::string & GetQoSDurability(void) const {
+    return mQoS.Durability;
+  }
+  bool SetQoSDeadline(const double & seconds);
+  inline double GetQoSDeadline(void) const {
+    return mQoS.Deadline;
+  }
+  bool SetQoSLifespan(const double & seconds);
+  inline double GetQoSLifespan(void) const {
+    return mQoS.Lifespan;
+  }
+
+  /*! Asynchronous mode, to avoid blocking the caller (usually the
+    GUI thread) while large messages are converted and serialized.
+    Publish copies the data in a bounded queue and returns right away,
+    a worker thread converts and publishes the queued messages.  When
+    the queue is full, the overflow policy is either "drop_oldest"
+    (default), "drop_newest" or "block" (Publish waits for the worker
+    thread).  These must be set before the publisher is added to a
+    ROS node, setters return false otherwise or if the value is
+    invalid.  Messages still queued when the publisher is removed are
+    discarded. */
+  bool SetAsynchronous(const bool & asynchronous);
+  inline bool GetAsynchronous(void) const {
+    return mAsynchronous;
+  }
+  bool SetQueueDepth(const int & depth);
+  inline int GetQueueDepth(void) const {
+    return mQueueDepth;
+  }
+  bool SetQueueOverflowPolicy(const std::string & policy);
+  inline const std::string & GetQueueOverflowPolicy(void) const {
+    return mQueueOverflowPolicy;
+  }
+
+  /*! Number of messages waiting to be published by the worker
+    thread. */
+  size_t GetQueueSize(void) const;
+
+  /*! Number of messages dropped because the queue was full. */
+  size_t GetNumberOfDroppedMessages(void) const;
+
+  /*! Publish the content of a MRML node each time it is modified,
+    without a Python observer.  Supported nodes depend on the
+    publisher type: transform nodes for PoseStamped, table nodes for
+    IntTable and DoubleTable, unsigned char volumes for UInt8Image,
+    volumes for Image, IntTensor and DoubleTensor and text nodes for
+    String.  Modifications are coalesced, the node is
+    published at most once per spin of the ROS node and at most at the
+    auto publish rate (in Hz, 0 for no limit other than the spin rate).
+    The last modification is always published.  Use nullptr to stop
+    observing.  Returns false if the node is not in the scene. */
+  bool ObserveNode(vtkMRMLNode * node);
+  vtkMRMLNode * GetObservedNode(void);
+
+  bool SetAutoPublishRate(const double & rate);
+  inline double GetAutoPublishRate(void) const {
+    return mAutoPublishRate;
+  }
+
+  /*! True if the observed node has been modified since it was last
+    published. */
+  inline bool GetAutoPublishPending(void) const {
+    return mAutoPublishPending;
+  }
+
+  /*! Publish the observed node now, returns false if there is no
+    observed node or it can't be converted. */
+  bool PublishObservedNode(void);
+
+  void ProcessMRMLEvents(vtkObject * caller, unsigned long event, void * callData) override;
+
   // Save and load
   virtual void ReadXMLAttributes(const char** atts) override;
   virtual void WriteXML(std::ostream& of, int indent) override;
   void UpdateScene(vtkMRMLScene *scene) override;
 
  protected:
-  vtkMRMLROS2PublisherNode() = default;
+  vtkMRMLROS2PublisherNode();
   ~vtkMRMLROS2PublisherNode() = default;
 
   vtkMRMLROS2PublisherInternals * mInternals;
@@ -60,6 +155,21 @@ class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2PublisherNode: public vtkMRM
 
   size_t mNumberOfCalls = 0;
   size_t mNumberOfMessagesSent = 0;
+  vtkMRMLROS2::QoSSettings mQoS{10};
+  bool SetQoS(const vtkMRMLROS2::QoSSettings & qos, const char * context);
+  bool mAsynchronous = false;
+  int mQueueDepth = 10;
+  std::string mQueueOverflowPolicy = "drop_oldest";
+  bool CheckNotAdded(const char * context);
+
+  double mAutoPublishRate = 0.0;
+  bool mAutoPublishPending = false;
+  double mLastAutoPublishTime = 0.0;
+
+  /*! Called by the ROS node after each spin, publishes the observed
+    node if it has been modified and the rate allows it.  Returns true
+    if a message was published. */
+  bool AutoPublish(void);
 
   // For ReadXMLAttributes
   inline void SetTopic(const std::string & topic) {
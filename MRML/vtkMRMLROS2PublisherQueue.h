@@ -0,0 +1,151 @@
+#ifndef __vtkMRMLROS2PublisherQueue_h
+#define __vtkMRMLROS2PublisherQueue_h
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/*! Bounded queue with its own worker thread, used by asynchronous
+  publishers.  The producer (usually the MRML thread) pushes snapshots
+  of the data to publish and the worker thread calls the consumer for
+  each of them, in order.  When the queue is full, the overflow policy
+  decides if the oldest item is dropped, the new item is dropped or
+  the producer blocks until the worker made some room. */
+template <typename _item_type>
+class vtkMRMLROS2PublisherQueue
+{
+public:
+  typedef enum {DropOldest, DropNewest, Block} PolicyType;
+  typedef std::function<void(_item_type &)> ConsumerType;
+
+  vtkMRMLROS2PublisherQueue() = default;
+  vtkMRMLROS2PublisherQueue(const vtkMRMLROS2PublisherQueue &) = delete;
+  vtkMRMLROS2PublisherQueue & operator = (const vtkMRMLROS2PublisherQueue &) = delete;
+
+  ~vtkMRMLROS2PublisherQueue()
+  {
+    Stop();
+  }
+
+  /*! Start the worker thread.  Depth is the maximum number of items
+    waiting to be consumed. */
+  void Start(const size_t & depth, const PolicyType & policy, ConsumerType consumer)
+  {
+    Stop();
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mDepth = (depth == 0) ? 1 : depth;
+      mPolicy = policy;
+      mStopped = false;
+    }
+    mWorker = std::thread([this, consumer]() {
+      _item_type item;
+      while (Pop(item)) {
+        consumer(item);
+        item = _item_type();
+      }
+    });
+  }
+
+  /*! Stop and join the worker thread.  Items still in the queue are
+    discarded and producers blocked in Push are released. */
+  void Stop(void)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStopped = true;
+      mItems.clear();
+    }
+    mNotEmpty.notify_all();
+    mNotFull.notify_all();
+    if (mWorker.joinable()) {
+      mWorker.join();
+    }
+  }
+
+  inline bool IsRunning(void) const {
+    return mWorker.joinable();
+  }
+
+  /*! Returns false if the new item has been dropped, either because
+    the queue is full and the policy is DropNewest or because the
+    queue has been stopped. */
+  bool Push(_item_type && item)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      if (mStopped) {
+        return false;
+      }
+      if (mItems.size() >= mDepth) {
+        switch (mPolicy) {
+        case DropOldest:
+          mItems.pop_front();
+          mNumberOfDroppedItems++;
+          break;
+        case DropNewest:
+          mNumberOfDroppedItems++;
+          return false;
+        case Block:
+          mNotFull.wait(lock, [this]() {
+            return mStopped || (mItems.size() < mDepth);
+          });
+          if (mStopped) {
+            return false;
+          }
+          break;
+        }
+      }
+      mItems.push_back(std::move(item));
+    }
+    mNotEmpty.notify_one();
+    return true;
+  }
+
+  /*! Number of items waiting to be consumed. */
+  size_t GetSize(void) const
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mItems.size();
+  }
+
+  /*! Number of items dropped because the queue was full. */
+  inline size_t GetNumberOfDroppedItems(void) const {
+    return mNumberOfDroppedItems.load();
+  }
+
+protected:
+  /*! Called by the worker thread, blocks until an item is available.
+    Returns false when the queue is stopped. */
+  bool Pop(_item_type & item)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mNotEmpty.wait(lock, [this]() {
+        return mStopped || !mItems.empty();
+      });
+      if (mStopped) {
+        return false;
+      }
+      item = std::move(mItems.front());
+      mItems.pop_front();
+    }
+    mNotFull.notify_one();
+    return true;
+  }
+
+  mutable std::mutex mMutex;
+  std::condition_variable mNotEmpty;
+  std::condition_variable mNotFull;
+  std::deque<_item_type> mItems;
+  size_t mDepth = 1;
+  PolicyType mPolicy = DropOldest;
+  bool mStopped = true;
+  std::atomic<size_t> mNumberOfDroppedItems{0};
+  std::thread mWorker;
+};
+
+#endif // __vtkMRMLROS2PublisherQueue_h
@@ -12,6 +12,9 @@ VTK_MRML_ROS_SUBSCRIBER_VTK_CXX(std_msgs::msg::Int64MultiArray, vtkIntArray, Int
 VTK_MRML_ROS_SUBSCRIBER_VTK_CXX(std_msgs::msg::Float64MultiArray, vtkDoubleArray, DoubleArray);
 VTK_MRML_ROS_SUBSCRIBER_VTK_CXX(std_msgs::msg::Int64MultiArray, vtkTable, IntTable);
 VTK_MRML_ROS_SUBSCRIBER_VTK_CXX(std_msgs::msg::Float64MultiArray, vtkTable, DoubleTable);
+VTK_MRML_ROS_SUBSCRIBER_VTK_CXX(std_msgs::msg::Int64MultiArray, vtkImageData, IntTensor);
+VTK_MRML_ROS_SUBSCRIBER_VTK_CXX(std_msgs::msg::Float64MultiArray, vtkImageData, DoubleTensor);
 
 VTK_MRML_ROS_SUBSCRIBER_VTK_CXX(sensor_msgs::msg::Joy, vtkTable, Joy)
 VTK_MRML_ROS_SUBSCRIBER_VTK_CXX(geometry_msgs::msg::PoseStamped, vtkMatrix4x4, PoseStamped)
+VTK_MRML_ROS_SUBSCRIBER_VTK_CXX(sensor_msgs::msg::Image, vtkImageData, Image)
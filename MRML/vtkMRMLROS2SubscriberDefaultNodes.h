@@ -11,13 +11,16 @@ VTK_MRML_ROS_SUBSCRIBER_NATIVE_H(double, Double);
 
 #include <vtkMatrix4x4.h>
 #include <vtkTable.h>
-#include <vtkTable.h>
+#include <vtkImageData.h>
 
 VTK_MRML_ROS_SUBSCRIBER_VTK_H(vtkIntArray, IntArray);
 VTK_MRML_ROS_SUBSCRIBER_VTK_H(vtkDoubleArray, DoubleArray);
 VTK_MRML_ROS_SUBSCRIBER_VTK_H(vtkTable, IntTable);
 VTK_MRML_ROS_SUBSCRIBER_VTK_H(vtkTable, DoubleTable);
+VTK_MRML_ROS_SUBSCRIBER_VTK_H(vtkImageData, IntTensor);
+VTK_MRML_ROS_SUBSCRIBER_VTK_H(vtkImageData, DoubleTensor);
 VTK_MRML_ROS_SUBSCRIBER_VTK_H(vtkTable, Joy);
 VTK_MRML_ROS_SUBSCRIBER_VTK_H(vtkMatrix4x4, PoseStamped);
+VTK_MRML_ROS_SUBSCRIBER_VTK_H(vtkImageData, Image);
 
 #endif // __vtkMRMLROS2SubscriberDefaultNodes_h
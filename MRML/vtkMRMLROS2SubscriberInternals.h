@@ -1,13 +1,44 @@
 #ifndef __vtkMRMLROS2SubscriberInternals_h
 #define __vtkMRMLROS2SubscriberInternals_h
 
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
 // ROS2 includes
 #include <rclcpp/rclcpp.hpp>
 
+#include <vtkNew.h>
+#include <vtkTable.h>
+#include <vtkDoubleArray.h>
+#include <vtkStringArray.h>
+#include <vtkTypeUInt64Array.h>
+
 #include <vtkMRMLScene.h>
 #include <vtkMRMLROS2Utils.h>
 #include <vtkMRMLROS2NodeNode.h>
 #include <vtkMRMLROS2NodeInternals.h>
+#include <vtkMRMLROS2MessageSlot.h>
+#include <vtkMRMLROS2MessageHistory.h>
+#include <vtkMRMLROS2MessageDecimation.h>
+#include <vtkMRMLROS2Tracer.h>
+#include <vtkSlicerToMRML.h>
+
+/*! YAML representation of a ROS message.  Overloaded for messages
+  without rosidl traits, see vtkMRMLROS2GenericMessage. */
+template <typename _ros_type>
+void vtkMRMLROS2ToYAML(const _ros_type & message, std::ostream & out)
+{
+  rosidl_generator_traits::to_yaml(message, out);
+}
+
+/*! True for ROS messages with a std_msgs/Header. */
+template <typename _ros_type, typename = void>
+struct vtkMRMLROS2HasHeader: std::false_type {};
+
+template <typename _ros_type>
+struct vtkMRMLROS2HasHeader<_ros_type, std::void_t<decltype(std::declval<_ros_type>().header.frame_id)>>:
+  std::true_type {};
 
 class vtkMRMLROS2SubscriberInternals
 {
@@ -25,6 +56,22 @@ public:
   virtual const char * GetROSType(void) const = 0;
   virtual const char * GetSlicerType(void) const = 0;
   virtual std::string GetLastMessageYAML(void) const = 0;
+  /*! Move the latest message received in the background thread to
+    the MRML node, returns true if there was a new message. */
+  virtual bool MoveLatestMessage(void) = 0;
+  /*! Fill the table with the messages in history more recent than
+    version, returns the number of messages (rows). */
+  virtual size_t GetMessagesSince(const size_t & version, vtkTable * result) = 0;
+  virtual size_t GetNumberOfDroppedHistoryMessages(void) const = 0;
+  /*! Apply the decimation settings from the MRML node, can be
+    called while the subscriber is added. */
+  virtual void UpdateDecimation(void) = 0;
+  virtual size_t GetNumberOfDroppedMessages(void) const = 0;
+  /*! Apply the latest message to a MRML node, see vtkSlicerToMRML. */
+  virtual bool UpdateMRMLNode(vtkMRMLNode * node, const int & row, std::string & errorMessage) = 0;
+  /*! Frame id of the latest message, empty if the message doesn't
+    have a header. */
+  virtual std::string GetLastMessageFrameId(void) const = 0;
 protected:
   vtkMRMLROS2SubscriberNode * mMRMLNode;
   std::shared_ptr<rclcpp::Node> mROSNode = nullptr;
@@ -43,19 +90,108 @@ public:
   {}
 
 protected:
-  _ros_type mLastMessageROS;
-  std::shared_ptr<rclcpp::Subscription<_ros_type>> mSubscription = nullptr;
+  /**
+   * Latest message received.  The message is shared with rclcpp (and
+   * other intra-process subscribers) so it is never copied.  Use
+   * GetLastMessageROS to access it, it is replaced atomically when a
+   * new message arrives.  Default is an empty message so there is
+   * always something to convert.
+   */
+  std::shared_ptr<const _ros_type> mLastMessageROS = std::make_shared<const _ros_type>();
+
+  /**
+   * True if the subscription uses intra-process comms, the messages
+   * are then shared with the publisher and other subscribers so the
+   * zero-copy conversion is not allowed (see GetCachedLastMessage).
+   */
+  bool mIntraProcess = false;
+
+  inline std::shared_ptr<const _ros_type> GetLastMessageROS(void) const {
+    return std::atomic_load(&mLastMessageROS);
+  }
+  rclcpp::SubscriptionBase::SharedPtr mSubscription = nullptr;
+
+  typedef std::function<void(std::shared_ptr<const _ros_type>)> CallbackType;
+
+  /**
+   * Create the ROS subscription, this can be overloaded for
+   * subscriptions that are not typed at compile time.
+   */
+  virtual rclcpp::SubscriptionBase::SharedPtr
+  CreateSubscription(const std::string & topic, const rclcpp::QoS & qos,
+                     CallbackType callback, const rclcpp::SubscriptionOptions & options)
+  {
+    return mROSNode->create_subscription<_ros_type>(topic, qos, callback, options);
+  }
+
+  /**
+   * Data shared with the background callback.  The callback captures
+   * a shared pointer so it never uses the internals after they are
+   * deleted.
+   */
+  typedef vtkMRMLROS2MessageHistory<const _ros_type> HistoryType;
+  struct CallbackState {
+    vtkMRMLROS2MessageSlot<const _ros_type> mSlot;
+    HistoryType mHistory;
+    vtkMRMLROS2MessageDecimation mDecimation;
+    std::atomic<size_t> mNumberOfDroppedMessages{0};
+    std::vector<double> mValues; // callback thread only
+
+    /*! Returns false and counts the message as dropped if it is
+      removed by the decimation. */
+    bool Accept(const _ros_type & message) {
+      if (!mDecimation.IsEnabled()) {
+        return true;
+      }
+      const bool hasValues = mDecimation.UsesValues() && vtkROS2ToSlicerValues(message, mValues);
+      if (mDecimation.Accept(vtkMRMLROS2TimeStatistics::Now(), hasValues ? &mValues : nullptr)) {
+        return true;
+      }
+      mNumberOfDroppedMessages++;
+      return false;
+    }
+  };
+  std::shared_ptr<CallbackState> mCallbackState = std::make_shared<CallbackState>();
+  size_t mNumberOfMessagesMoved = 0;
+
+  /**
+   * Version (see vtkMRMLROS2SubscriberNode::GetLastMessageVersion) of
+   * the message last converted to the Slicer type.  Initialized so
+   * the default (empty) message is converted on first access.
+   */
+  size_t mLastMessageSlicerVersion = std::numeric_limits<size_t>::max();
+
+  /**
+   * Returns true if the latest message has not been converted yet,
+   * and assumes the caller will convert it.
+   */
+  bool ConversionRequired(void)
+  {
+    const size_t version = mMRMLNode->GetLastMessageVersion();
+    if (version == mLastMessageSlicerVersion) {
+      return false;
+    }
+    mLastMessageSlicerVersion = version;
+    return true;
+  }
 
   /**
    * This is the ROS callback for the subscription.  This methods
-   * saves the ROS message as-is and set the modified flag for the
-   * MRML node
+   * keeps a pointer on the ROS message (no copy) and set the
+   * modified flag for the MRML node
    */
-  void SubscriberCallback(const _ros_type & message) {
+  void SubscriberCallback(std::shared_ptr<const _ros_type> message) {
+    vtkMRMLROS2Tracer::Scope trace("ros", "SubscriberCallback", mMRMLNode->mTopic);
+    if (!mCallbackState->Accept(*message)) {
+      return;
+    }
+    const double start = vtkMRMLROS2TimeStatistics::Now();
     // \todo is there a timestamp in MRML nodes we can update from the ROS message?
-    mLastMessageROS = message;
     mMRMLNode->mNumberOfMessages++;
-    mMRMLNode->Modified();
+    mCallbackState->mHistory.Add(mMRMLNode->mNumberOfMessages, HistoryType::Now(), message);
+    std::atomic_store(&mLastMessageROS, std::move(message));
+    mMRMLNode->MessagesReceived(1);
+    mMRMLNode->mCallbackStatistics->AddSample(vtkMRMLROS2TimeStatistics::Now() - start);
   }
 
   /**
@@ -73,9 +209,46 @@ protected:
       return false;
     }
     mROSNode = mrmlROSNodePtr->mInternals->mNodePointer;
-    mSubscription
-      = mROSNode->create_subscription<_ros_type>(topic, 100,
-                                                 std::bind(&SelfType::SubscriberCallback, this, std::placeholders::_1));
+    // set before the subscription is created, the history is not thread safe
+    mCallbackState->mHistory.SetDepth(mMRMLNode->mHistoryDepth);
+    const rclcpp::QoS qos = vtkMRMLROS2::ToROS2QoS(mMRMLNode->mQoS);
+    rclcpp::SubscriptionOptions options;
+    mIntraProcess = mrmlROSNodePtr->GetIntraProcess();
+    if (mIntraProcess
+        && !vtkMRMLROS2::QoSAllowsIntraProcess(mMRMLNode->mQoS)) {
+      options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+      mIntraProcess = false;
+    }
+    rclcpp::CallbackGroup::SharedPtr backgroundGroup = mrmlROSNodePtr->mInternals->mBackgroundCallbackGroup;
+    CallbackType callback;
+    if (mrmlROSNodePtr->GetSpinInBackground() && backgroundGroup) {
+      // the background callback can't touch MRML, it just keeps the latest message
+      options.callback_group = backgroundGroup;
+      std::shared_ptr<CallbackState> state = mCallbackState;
+      callback = [state, topic](std::shared_ptr<const _ros_type> message) {
+                   vtkMRMLROS2Tracer::Scope trace("ros", "BackgroundSubscriberCallback", topic);
+                   if (!state->Accept(*message)) {
+                     return;
+                   }
+                   if (state->mHistory.GetDepth() != 0) {
+                     // single producer, the version is the next number of puts
+                     state->mHistory.Push(state->mSlot.GetNumberOfPuts() + 1, HistoryType::Now(), message);
+                   }
+                   // only wake up the main thread once until the message is moved to MRML
+                   if (state->mSlot.Put(std::move(message))) {
+                     vtkMRMLROS2::NotifyWakeup();
+                   }
+                 };
+    } else {
+      callback = std::bind(&SelfType::SubscriberCallback, this, std::placeholders::_1);
+    }
+    mSubscription = CreateSubscription(topic, qos, callback, options);
+    if (!mSubscription) {
+      errorMessage = "unable to create subscription for topic \"" + topic + "\"";
+      mROSNode.reset();
+      mIntraProcess = false;
+      return false;
+    }
     mrmlROSNodePtr->SetNthNodeReferenceID("subscriber",
                                           mrmlROSNodePtr->GetNumberOfNodeReferences("subscriber"),
                                           mMRMLNode->GetID());
@@ -102,6 +275,7 @@ protected:
 
     mSubscription.reset();
     mROSNode.reset();
+    mIntraProcess = false;
 
     return true;
   }
@@ -111,6 +285,96 @@ protected:
     return (mSubscription != nullptr);
   }
 
+  bool MoveLatestMessage(void) override
+  {
+    mCallbackState->mHistory.Drain();
+    std::shared_ptr<const _ros_type> latest = mCallbackState->mSlot.Take();
+    if (latest == nullptr) {
+      return false;
+    }
+    vtkMRMLROS2Tracer::Scope trace("ros", "MoveLatestMessage", mMRMLNode->mTopic);
+    const double start = vtkMRMLROS2TimeStatistics::Now();
+    // account for the messages replaced in the slot before we could take them
+    const size_t numberOfPuts = mCallbackState->mSlot.GetNumberOfPuts();
+    const size_t numberOfMessages = numberOfPuts - mNumberOfMessagesMoved;
+    mMRMLNode->mNumberOfMessages += numberOfMessages;
+    mNumberOfMessagesMoved = numberOfPuts;
+    std::atomic_store(&mLastMessageROS, std::move(latest));
+    mMRMLNode->MessagesReceived(numberOfMessages);
+    mMRMLNode->mCallbackStatistics->AddSample(vtkMRMLROS2TimeStatistics::Now() - start);
+    return true;
+  }
+
+  size_t GetMessagesSince(const size_t & version, vtkTable * result) override
+  {
+    HistoryType & history = mCallbackState->mHistory;
+    history.Drain();
+    std::vector<const typename HistoryType::Sample *> samples;
+    history.GetSamplesSince(version, samples);
+    const vtkIdType numberOfRows = samples.size();
+
+    result->Initialize();
+    vtkNew<vtkTypeUInt64Array> versions;
+    versions->SetName("version");
+    versions->SetNumberOfValues(numberOfRows);
+    vtkNew<vtkDoubleArray> times;
+    times->SetName("time");
+    times->SetNumberOfValues(numberOfRows);
+    for (vtkIdType row = 0; row < numberOfRows; ++row) {
+      versions->SetValue(row, samples[row]->Version);
+      times->SetValue(row, samples[row]->Time);
+    }
+    result->AddColumn(versions);
+    result->AddColumn(times);
+
+    // numeric messages are stored in a single multi-component column
+    std::vector<double> values;
+    if ((numberOfRows > 0)
+        && vtkROS2ToSlicerValues(*(samples[0]->Message), values)) {
+      const size_t numberOfComponents = std::max(values.size(), static_cast<size_t>(1));
+      vtkNew<vtkDoubleArray> column;
+      column->SetName("value");
+      column->SetNumberOfComponents(numberOfComponents);
+      column->SetNumberOfTuples(numberOfRows);
+      for (vtkIdType row = 0; row < numberOfRows; ++row) {
+        vtkROS2ToSlicerValues(*(samples[row]->Message), values);
+        values.resize(numberOfComponents, 0.0); // in case the message size changed
+        column->SetTypedTuple(row, values.data());
+      }
+      result->AddColumn(column);
+    } else {
+      // other messages are stored as YAML
+      vtkNew<vtkStringArray> column;
+      column->SetName("value");
+      column->SetNumberOfValues(numberOfRows);
+      for (vtkIdType row = 0; row < numberOfRows; ++row) {
+        std::stringstream out;
+        vtkMRMLROS2ToYAML(*(samples[row]->Message), out);
+        column->SetValue(row, out.str());
+      }
+      result->AddColumn(column);
+    }
+    return numberOfRows;
+  }
+
+  void UpdateDecimation(void) override
+  {
+    vtkMRMLROS2MessageDecimation & decimation = mCallbackState->mDecimation;
+    decimation.SetEveryNth(mMRMLNode->mDecimationEveryNth);
+    decimation.SetMaximumRate(mMRMLNode->mDecimationMaximumRate);
+    decimation.SetMinimumChange(mMRMLNode->mDecimationMinimumChange);
+  }
+
+  size_t GetNumberOfDroppedHistoryMessages(void) const override
+  {
+    return mCallbackState->mHistory.GetNumberOfDroppedMessages();
+  }
+
+  size_t GetNumberOfDroppedMessages(void) const override
+  {
+    return mCallbackState->mNumberOfDroppedMessages.load();
+  }
+
   const char * GetROSType(void) const override
   {
     return rosidl_generator_traits::name<_ros_type>();
@@ -124,9 +388,17 @@ protected:
   std::string GetLastMessageYAML(void) const override
   {
     std::stringstream out;
-    rosidl_generator_traits::to_yaml(mLastMessageROS, out);
+    vtkMRMLROS2ToYAML(*GetLastMessageROS(), out);
     return out.str();
   }
+
+  std::string GetLastMessageFrameId(void) const override
+  {
+    if constexpr (vtkMRMLROS2HasHeader<_ros_type>::value) {
+      return GetLastMessageROS()->header.frame_id;
+    }
+    return std::string();
+  }
 };
 
 
@@ -144,16 +416,35 @@ public:
 
   _slicer_type mLastMessageSlicer;
 
+  /**
+   * Convert the latest ROS message if it has not been converted yet
+   * and return the cached result.
+   */
+  const _slicer_type & GetCachedLastMessage(void)
+  {
+    if (this->ConversionRequired()) {
+      vtkMRMLROS2Tracer::Scope trace("conversion", "vtkROS2ToSlicer", this->mMRMLNode->GetTopic());
+      const double start = vtkMRMLROS2TimeStatistics::Now();
+      vtkROS2ToSlicer(*(this->GetLastMessageROS()), mLastMessageSlicer);
+      this->mMRMLNode->GetConversionStatistics()->AddSample(vtkMRMLROS2TimeStatistics::Now() - start);
+    }
+    return mLastMessageSlicer;
+  }
+
   void GetLastMessage(_slicer_type & result)
   {
     // todo maybe add some check that we actually received a message?
-    vtkROS2ToSlicer(this->mLastMessageROS, result);
+    result = GetCachedLastMessage();
   }
 
   vtkVariant GetLastMessageVariant(void)
   {
-    GetLastMessage(mLastMessageSlicer);
-    return vtkVariant(mLastMessageSlicer);
+    return vtkVariant(GetCachedLastMessage());
+  }
+
+  bool UpdateMRMLNode(vtkMRMLNode * node, const int & row, std::string & errorMessage) override
+  {
+    return vtkSlicerToMRML(GetCachedLastMessage(), node, row, errorMessage);
   }
 };
 
@@ -174,16 +465,57 @@ public:
 
   vtkSmartPointer<_slicer_type> mLastMessageSlicer;
 
+  /**
+   * ROS message used by the cached result in zero-copy mode, kept
+   * alive until the next conversion.
+   */
+  std::shared_ptr<const _ros_type> mZeroCopyMessage;
+
+  /**
+   * Convert the latest ROS message if it has not been converted yet
+   * and return the cached result.  The cached object is updated in
+   * place when a new message is converted.
+   */
+  _slicer_type * GetCachedLastMessage(void)
+  {
+    if (this->ConversionRequired()) {
+      vtkMRMLROS2Tracer::Scope trace("conversion", "vtkROS2ToSlicer", this->mMRMLNode->GetTopic());
+      const double start = vtkMRMLROS2TimeStatistics::Now();
+      std::shared_ptr<const _ros_type> message = this->GetLastMessageROS();
+      // the array returned to the user is mutable, never alias a
+      // message shared with other intra-process subscribers
+      if (this->mMRMLNode->GetZeroCopy()
+          && !this->mIntraProcess
+          && vtkROS2ToSlicerZeroCopy(*message, mLastMessageSlicer.GetPointer())) {
+        // the previous message can be released now
+        mZeroCopyMessage = message;
+      } else {
+        if (mZeroCopyMessage) {
+          // release the memory of the previous message before reusing the result
+          mLastMessageSlicer->Initialize();
+          mZeroCopyMessage.reset();
+        }
+        vtkROS2ToSlicer(*message, mLastMessageSlicer);
+      }
+      this->mMRMLNode->GetConversionStatistics()->AddSample(vtkMRMLROS2TimeStatistics::Now() - start);
+    }
+    return mLastMessageSlicer.GetPointer();
+  }
+
   void GetLastMessage(_slicer_type * result)
   {
     // todo maybe add some check that we actually received a message?
-    vtkROS2ToSlicer(this->mLastMessageROS, result);
+    result->DeepCopy(GetCachedLastMessage());
   }
 
   vtkVariant GetLastMessageVariant(void)
   {
-    GetLastMessage(mLastMessageSlicer.GetPointer());
-    return vtkVariant(mLastMessageSlicer.GetPointer());
+    return vtkVariant(GetCachedLastMessage());
+  }
+
+  bool UpdateMRMLNode(vtkMRMLNode * node, const int & row, std::string & errorMessage) override
+  {
+    return vtkSlicerToMRML(GetCachedLastMessage(), node, row, errorMessage);
   }
 };
 
@@ -123,9 +123,7 @@
                                                                         \
   slicer_type * vtkMRMLROS2Subscriber##name##Node::GetLastMessage(void) const \
   {                                                                     \
-    vtkSmartPointer<slicer_type> result = slicer_type::New();           \
-    this->GetLastMessage(result);                                       \
-    return result;                                                      \
+    return (reinterpret_cast<vtkMRMLROS2Subscriber##name##Internals *>(mInternals))->GetCachedLastMessage(); \
   }                                                                     \
                                                                         \
   void vtkMRMLROS2Subscriber##name##Node::GetLastMessage(vtkSmartPointer<slicer_type> message) const \
@@ -2,6 +2,12 @@
 #include <vtkMRMLROS2SubscriberNode.h>
 
 #include <vtkMRMLROS2SubscriberInternals.h>
+#include <vtkMRMLROS2Tracer.h>
+#include <vtkMRMLROS2Tf2LookupNode.h>
+
+#include <vtkMRMLTransformableNode.h>
+
+#include <vtkCommand.h>
 
 
 void vtkMRMLROS2SubscriberNode::PrintSelf(ostream& os, vtkIndent indent)
@@ -12,6 +18,9 @@ void vtkMRMLROS2SubscriberNode::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "ROS type: " << mInternals->GetROSType() << "\n";
   os << indent << "Slicer type: " << mInternals->GetSlicerType() << "\n"; // This is scrambled
   os << indent << "Number of messages: " << mNumberOfMessages << "\n";
+  os << indent << "Number of dropped messages: " << GetNumberOfDroppedMessages() << "\n";
+  os << indent << "Driven node: " << (this->GetNodeReferenceID("driven") ? this->GetNodeReferenceID("driven") : "none") << "\n";
+  os << indent << "Coalesce modified events: " << (mCoalesceModifiedEvents ? "true" : "false") << "\n";
   os << indent << "Last message:" << mInternals->GetLastMessageYAML() << "\n";
 }
 
@@ -71,11 +80,283 @@ std::string vtkMRMLROS2SubscriberNode::GetLastMessageYAML(void) const
 }
 
 
+bool vtkMRMLROS2SubscriberNode::MoveLatestMessage(void)
+{
+  return mInternals->MoveLatestMessage();
+}
+
+
+bool vtkMRMLROS2SubscriberNode::SetQoSHistory(const std::string & history)
+{
+  vtkMRMLROS2::QoSSettings qos = mQoS;
+  qos.History = history;
+  return SetQoS(qos, "SetQoSHistory");
+}
+
+
+bool vtkMRMLROS2SubscriberNode::SetQoSDepth(const int & depth)
+{
+  vtkMRMLROS2::QoSSettings qos = mQoS;
+  qos.Depth = depth;
+  return SetQoS(qos, "SetQoSDepth");
+}
+
+
+bool vtkMRMLROS2SubscriberNode::SetQoSReliability(const std::string & reliability)
+{
+  vtkMRMLROS2::QoSSettings qos = mQoS;
+  qos.Reliability = reliability;
+  return SetQoS(qos, "SetQoSReliability");
+}
+
+
+bool vtkMRMLROS2SubscriberNode::SetQoSDurability(const std::string & durability)
+{
+  vtkMRMLROS2::QoSSettings qos = mQoS;
+  qos.Durability = durability;
+  return SetQoS(qos, "SetQoSDurability");
+}
+
+
+bool vtkMRMLROS2SubscriberNode::SetQoSDeadline(const double & seconds)
+{
+  vtkMRMLROS2::QoSSettings qos = mQoS;
+  qos.Deadline = seconds;
+  return SetQoS(qos, "SetQoSDeadline");
+}
+
+
+bool vtkMRMLROS2SubscriberNode::SetQoSLifespan(const double & seconds)
+{
+  vtkMRMLROS2::QoSSettings qos = mQoS;
+  qos.Lifespan = seconds;
+  return SetQoS(qos, "SetQoSLifespan");
+}
+
+
+bool vtkMRMLROS2SubscriberNode::SetQoS(const vtkMRMLROS2::QoSSettings & qos, const char * context)
+{
+  if (IsAddedToROS2Node()) {
+    vtkErrorMacro(<< context << ": QoS must be set before the subscriber for topic \"" << mTopic << "\" is added to the ROS node");
+    return false;
+  }
+  std::string errorMessage;
+  if (!vtkMRMLROS2::CheckQoSSettings(qos, errorMessage)) {
+    vtkErrorMacro(<< context << ": " << errorMessage);
+    return false;
+  }
+  mQoS = qos;
+  return true;
+}
+
+
+bool vtkMRMLROS2SubscriberNode::SetHistoryDepth(const int & depth)
+{
+  if (IsAddedToROS2Node()) {
+    vtkErrorMacro(<< "SetHistoryDepth: history depth must be set before the subscriber for topic \"" << mTopic << "\" is added to the ROS node");
+    return false;
+  }
+  if (depth < 0) {
+    vtkErrorMacro(<< "SetHistoryDepth: depth can't be negative");
+    return false;
+  }
+  mHistoryDepth = depth;
+  return true;
+}
+
+
+bool vtkMRMLROS2SubscriberNode::SetDecimationEveryNth(const int & everyNth)
+{
+  if (everyNth < 1) {
+    vtkErrorMacro(<< "SetDecimationEveryNth: value must be at least 1");
+    return false;
+  }
+  mDecimationEveryNth = everyNth;
+  mInternals->UpdateDecimation();
+  return true;
+}
+
+
+bool vtkMRMLROS2SubscriberNode::SetDecimationMaximumRate(const double & rate)
+{
+  if (rate < 0.0) {
+    vtkErrorMacro(<< "SetDecimationMaximumRate: rate can't be negative");
+    return false;
+  }
+  mDecimationMaximumRate = rate;
+  mInternals->UpdateDecimation();
+  return true;
+}
+
+
+bool vtkMRMLROS2SubscriberNode::SetDecimationMinimumChange(const double & change)
+{
+  if (change < 0.0) {
+    vtkErrorMacro(<< "SetDecimationMinimumChange: change can't be negative");
+    return false;
+  }
+  mDecimationMinimumChange = change;
+  mInternals->UpdateDecimation();
+  return true;
+}
+
+
+size_t vtkMRMLROS2SubscriberNode::GetNumberOfDroppedMessages(void) const
+{
+  return mInternals->GetNumberOfDroppedMessages();
+}
+
+
+size_t vtkMRMLROS2SubscriberNode::GetMessagesSince(const size_t & version, vtkTable * result)
+{
+  if (result == nullptr) {
+    vtkErrorMacro(<< "GetMessagesSince: result table is null");
+    return 0;
+  }
+  return mInternals->GetMessagesSince(version, result);
+}
+
+
+size_t vtkMRMLROS2SubscriberNode::GetHistoryAsTable(vtkTable * result)
+{
+  return GetMessagesSince(0, result);
+}
+
+
+size_t vtkMRMLROS2SubscriberNode::GetNumberOfDroppedHistoryMessages(void) const
+{
+  return mInternals->GetNumberOfDroppedHistoryMessages();
+}
+
+
+bool vtkMRMLROS2SubscriberNode::DriveNode(vtkMRMLNode * node)
+{
+  if (node == nullptr) {
+    this->SetNodeReferenceID("driven", nullptr);
+    return true;
+  }
+  if (!this->GetScene() || (this->GetScene()->GetNodeByID(node->GetID()) != node)) {
+    vtkErrorMacro(<< "DriveNode: node must be in the same scene as the subscriber for topic \"" << mTopic << "\"");
+    return false;
+  }
+  this->SetNodeReferenceID("driven", node->GetID());
+  // apply the latest message, if any, on the next spin
+  mDrivenNodeVersion = 0;
+  mDrivenFrameId.clear();
+  return true;
+}
+
+
+vtkMRMLNode * vtkMRMLROS2SubscriberNode::GetDrivenNode(void)
+{
+  return this->GetNodeReference("driven");
+}
+
+
+bool vtkMRMLROS2SubscriberNode::UpdateDrivenNode(void)
+{
+  const size_t version = GetLastMessageVersion();
+  if ((version == 0) || (version == mDrivenNodeVersion)) {
+    return false;
+  }
+  vtkMRMLNode * node = GetDrivenNode();
+  if (node == nullptr) {
+    return false;
+  }
+  vtkMRMLROS2Tracer::Scope trace("mrml", "UpdateDrivenNode", mTopic);
+  mDrivenNodeVersion = version;
+  std::string errorMessage;
+  if (!mInternals->UpdateMRMLNode(node, mDrivenTableRow, errorMessage)) {
+    // don't report the same error for every message
+    vtkErrorMacro(<< "UpdateDrivenNode: " << errorMessage << ", subscriber for topic \"" << mTopic << "\" stops driving the node");
+    this->SetNodeReferenceID("driven", nullptr);
+    return false;
+  }
+  PlaceDrivenNode(node);
+  return true;
+}
+
+
+void vtkMRMLROS2SubscriberNode::PlaceDrivenNode(vtkMRMLNode * node)
+{
+  vtkMRMLTransformableNode * transformable = vtkMRMLTransformableNode::SafeDownCast(node);
+  // transform nodes are driven by their content, not placed
+  if (!transformable || vtkMRMLTransformNode::SafeDownCast(node) || !this->GetScene()) {
+    return;
+  }
+  const std::string frameId = mInternals->GetLastMessageFrameId();
+  if (frameId.empty() || (frameId == mDrivenFrameId)) {
+    return;
+  }
+  vtkMRMLTransformNode * frame = nullptr;
+  std::vector<vtkMRMLNode *> lookups;
+  this->GetScene()->GetNodesByClass("vtkMRMLROS2Tf2LookupNode", lookups);
+  for (auto lookup : lookups) {
+    if (vtkMRMLROS2Tf2LookupNode::SafeDownCast(lookup)->GetChildID() == frameId) {
+      frame = vtkMRMLTransformNode::SafeDownCast(lookup);
+      break;
+    }
+  }
+  if (!frame) {
+    frame = vtkMRMLTransformNode::SafeDownCast(this->GetScene()->GetFirstNodeByName(frameId.c_str()));
+  }
+  if (!frame) {
+    // try again with the next message, the frame might be added later
+    return;
+  }
+  mDrivenFrameId = frameId;
+  transformable->SetAndObserveTransformNodeID(frame->GetID());
+}
+
+
+void vtkMRMLROS2SubscriberNode::MessagesReceived(const size_t & numberOfMessages)
+{
+  mNumberOfMessagesSinceModified += numberOfMessages;
+  if (!mCoalesceModifiedEvents) {
+    FlushModifiedEvent();
+  }
+}
+
+
+bool vtkMRMLROS2SubscriberNode::FlushModifiedEvent(void)
+{
+  if (mNumberOfMessagesSinceModified == 0) {
+    return false;
+  }
+  vtkMRMLROS2Tracer::Scope trace("mrml", "Modified", mTopic);
+  mNumberOfMessagesInLastModified = mNumberOfMessagesSinceModified;
+  mNumberOfMessagesSinceModified = 0;
+  if (this->GetDisableModifiedEvent()) {
+    // let vtkMRMLNode keep track of the pending event
+    this->Modified();
+  } else {
+    // same as vtkObject::Modified, with the number of messages as call data
+    int numberOfMessages = static_cast<int>(mNumberOfMessagesInLastModified);
+    this->MTime.Modified();
+    this->InvokeEvent(vtkCommand::ModifiedEvent, &numberOfMessages);
+  }
+  return true;
+}
+
+
 void vtkMRMLROS2SubscriberNode::WriteXML(std::ostream& of, int nIndent)
 {
   Superclass::WriteXML(of, nIndent); // This will take care of referenced nodes
   vtkMRMLWriteXMLBeginMacro(of);
   vtkMRMLWriteXMLStdStringMacro(topicName, Topic);
+  vtkMRMLWriteXMLBooleanMacro(coalesceModifiedEvents, CoalesceModifiedEvents);
+  vtkMRMLWriteXMLBooleanMacro(zeroCopy, ZeroCopy);
+  vtkMRMLWriteXMLIntMacro(historyDepth, HistoryDepth);
+  vtkMRMLWriteXMLIntMacro(decimationEveryNth, DecimationEveryNth);
+  vtkMRMLWriteXMLFloatMacro(decimationMaximumRate, DecimationMaximumRate);
+  vtkMRMLWriteXMLFloatMacro(decimationMinimumChange, DecimationMinimumChange);
+  vtkMRMLWriteXMLIntMacro(drivenTableRow, DrivenTableRow);
+  vtkMRMLWriteXMLStdStringMacro(qosHistory, QoSHistory);
+  vtkMRMLWriteXMLIntMacro(qosDepth, QoSDepth);
+  vtkMRMLWriteXMLStdStringMacro(qosReliability, QoSReliability);
+  vtkMRMLWriteXMLStdStringMacro(qosDurability, QoSDurability);
+  vtkMRMLWriteXMLFloatMacro(qosDeadline, QoSDeadline);
+  vtkMRMLWriteXMLFloatMacro(qosLifespan, QoSLifespan);
   vtkMRMLWriteXMLEndMacro();
 }
 
@@ -86,6 +367,19 @@ void vtkMRMLROS2SubscriberNode::ReadXMLAttributes(const char** atts)
   Superclass::ReadXMLAttributes(atts); // This will take care of referenced nodes
   vtkMRMLReadXMLBeginMacro(atts);
   vtkMRMLReadXMLStdStringMacro(topicName, Topic);
+  vtkMRMLReadXMLBooleanMacro(coalesceModifiedEvents, CoalesceModifiedEvents);
+  vtkMRMLReadXMLBooleanMacro(zeroCopy, ZeroCopy);
+  vtkMRMLReadXMLIntMacro(historyDepth, HistoryDepth);
+  vtkMRMLReadXMLIntMacro(decimationEveryNth, DecimationEveryNth);
+  vtkMRMLReadXMLFloatMacro(decimationMaximumRate, DecimationMaximumRate);
+  vtkMRMLReadXMLFloatMacro(decimationMinimumChange, DecimationMinimumChange);
+  vtkMRMLReadXMLIntMacro(drivenTableRow, DrivenTableRow);
+  vtkMRMLReadXMLStdStringMacro(qosHistory, QoSHistory);
+  vtkMRMLReadXMLIntMacro(qosDepth, QoSDepth);
+  vtkMRMLReadXMLStdStringMacro(qosReliability, QoSReliability);
+  vtkMRMLReadXMLStdStringMacro(qosDurability, QoSDurability);
+  vtkMRMLReadXMLFloatMacro(qosDeadline, QoSDeadline);
+  vtkMRMLReadXMLFloatMacro(qosLifespan, QoSLifespan);
   vtkMRMLReadXMLEndMacro();
   this->EndModify(wasModifying);
 }
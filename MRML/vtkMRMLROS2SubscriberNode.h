@@ -3,11 +3,15 @@
 
 // MRML includes
 #include <vtkMRMLNode.h>
+#include <vtkSmartPointer.h>
 
 #include <vtkSlicerROS2ModuleMRMLExport.h>
+#include <vtkMRMLROS2TimeStatistics.h>
+#include <vtkMRMLROS2Utils.h>
 
 // forward declaration for internals
 class vtkMRMLROS2SubscriberInternals;
+class vtkTable;
 
 class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2SubscriberNode: public vtkMRMLNode
 {
@@ -17,6 +21,7 @@ class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2SubscriberNode: public vtkMR
 
   template <typename _ros_type, typename _slicer_type>
     friend class vtkMRMLROS2SubscriberTemplatedInternals;
+  friend class vtkMRMLROS2NodeNode;
 
  public:
   vtkTypeMacro(vtkMRMLROS2SubscriberNode, vtkMRMLNode);
@@ -40,8 +45,173 @@ class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2SubscriberNode: public vtkMR
     return mNumberOfMessages;
   }
 
+  /*! Changes each time a new message is received, 0 if no message has
+    been received yet.  Callers can keep the last version they
+    processed to skip unchanged data.  The conversion to the Slicer
+    type (GetLastMessage) is performed at most once per version. */
+  size_t GetLastMessageVersion(void) const {
+    return mNumberOfMessages;
+  }
+
   void PrintSelf(ostream& os, vtkIndent indent) override;
 
+  /*! Time spent storing each new message in the MRML node, including
+    the Modified event and all its observers. */
+  inline vtkMRMLROS2TimeStatistics * GetCallbackStatistics(void) {
+    return mCallbackStatistics;
+  }
+
+  /*! Time spent converting the ROS message to the Slicer type. */
+  inline vtkMRMLROS2TimeStatistics * GetConversionStatistics(void) {
+    return mConversionStatistics;
+  }
+
+  /*! QoS used when the subscriber is added to a ROS node, so these
+    must be set before AddToROS2Node.  History is "keep_last"
+    (default) or "keep_all", depth is the queue size for keep_last,
+    reliability is "reliable" (default) or "best_effort", durability is
+    "volatile" (default) or "transient_local".  Deadline and lifespan
+    are in seconds, 0 (default) means infinite.  Setters return false
+    if the value is invalid or the subscriber is already added. */
+  bool SetQoSHistory(const std::string & history);
+  inline const std::string & GetQoSHistory(void) const {
+    return mQoS.History;
+  }
+  bool SetQoSDepth(const int & depth);
+  inline int GetQoSDepth(void) const {
+    return mQoS.Depth;
+  }
+  bool SetQoSReliability(const std::string & reliability);
+  inline const std::string & GetQoSReliability(void) const {
+    return mQoS.Reliability;
+  }
+  bool SetQoSDurability(const std::string & durability);
+  inline const std::string & GetQoSDurability(void) const {
+    return mQoS.Durability;
+  }
+  bool SetQoSDeadline(const double & seconds);
+  inline double GetQoSDeadline(void) const {
+    return mQoS.Deadline;
+  }
+  bool SetQoSLifespan(const double & seconds);
+  inline double GetQoSLifespan(void) const {
+    return mQoS.Lifespan;
+  }
+
+  /*! Number of messages kept in the history, 0 (default) to disable
+    the history.  Must be set before the subscriber is added to a ROS
+    node, returns false otherwise. */
+  bool SetHistoryDepth(const int & depth);
+  inline int GetHistoryDepth(void) const {
+    return mHistoryDepth;
+  }
+
+  /*! Fill the table with the messages in history received after the
+    given version (see GetLastMessageVersion), oldest first.  The
+    table has one row per message and the columns "version", "time"
+    (reception time in seconds) and "value".  For numeric messages
+    (including arrays and poses), "value" is a multi-component array
+    of doubles.  Other messages are stored as YAML strings.  Returns
+    the number of messages. */
+  size_t GetMessagesSince(const size_t & version, vtkTable * result);
+
+  /*! All the messages in history, see GetMessagesSince. */
+  size_t GetHistoryAsTable(vtkTable * result);
+
+  /*! Number of messages received in background (see
+    vtkMRMLROS2NodeNode::SetSpinInBackground) that never made it to
+    the history because more than the history depth were received
+    between two spins.  The history always ends with the latest
+    message. */
+  size_t GetNumberOfDroppedHistoryMessages(void) const;
+
+  /*! Decimation, to reduce the number of messages processed for
+    high frequency topics.  Messages are kept if they pass all the
+    enabled criteria: one message out of every Nth (1 to disable),
+    maximum rate in Hz (0 to disable) and minimum change (0 to
+    disable).  The change is the largest absolute difference between
+    the values of the new message and the last message kept (see
+    GetMessagesSince for numeric types, positions are in millimeters),
+    it is ignored for non-numeric types.  Dropped messages are not
+    counted in GetNumberOfMessages and don't trigger Modified events.
+    These can be changed while the subscriber is added.  Setters
+    return false if the value is invalid. */
+  bool SetDecimationEveryNth(const int & everyNth);
+  inline int GetDecimationEveryNth(void) const {
+    return mDecimationEveryNth;
+  }
+  bool SetDecimationMaximumRate(const double & rate);
+  inline double GetDecimationMaximumRate(void) const {
+    return mDecimationMaximumRate;
+  }
+  bool SetDecimationMinimumChange(const double & change);
+  inline double GetDecimationMinimumChange(void) const {
+    return mDecimationMinimumChange;
+  }
+
+  /*! Number of messages dropped by the decimation. */
+  size_t GetNumberOfDroppedMessages(void) const;
+
+  /*! Apply the latest message to a MRML node, without a Python
+    observer.  Supported nodes depend on the subscriber type:
+    transform nodes for PoseStamped, text nodes for String, volume
+    nodes for Image, IntTensor and DoubleTensor and table nodes for
+    numbers, arrays and tables.  For tables, the driven row is the
+    row updated with the message values, -1 (default) to replace the
+    whole table (table messages) or update the first row.
+    The node is updated at most once per spin of the ROS node.  For
+    messages with a header, a driven node that is not a transform is
+    placed under the transform of its frame id when it changes: the
+    tf2 lookup node with this child id or else the transform node
+    with this name, if any.  The driven node is saved in the scene as
+    a node reference.  Use
+    nullptr to stop driving a node.  Returns false if the node is not
+    in the scene. */
+  bool DriveNode(vtkMRMLNode * node);
+  vtkMRMLNode * GetDrivenNode(void);
+  inline void SetDrivenTableRow(const int & row) {
+    mDrivenTableRow = row;
+  }
+  inline int GetDrivenTableRow(void) const {
+    return mDrivenTableRow;
+  }
+
+  /*! Zero-copy mode, the object returned by GetLastMessage() uses
+    the memory of the latest ROS message instead of a copy.  This is
+    only supported for Float64MultiArray to vtkDoubleArray (see
+    vtkMRMLROS2SubscriberDoubleArrayNode) and ignored for other
+    types.  The array must be considered read-only and is valid until
+    the next message is converted; use GetLastMessage(result) to keep
+    a copy.  Zero-copy is ignored if the subscriber uses intra-process
+    comms (see vtkMRMLROS2NodeNode::Create) since the message is then
+    shared with the publisher and the other subscribers.  Default is
+    false. */
+  inline void SetZeroCopy(const bool & zeroCopy) {
+    mZeroCopy = zeroCopy;
+  }
+  inline bool GetZeroCopy(void) const {
+    return mZeroCopy;
+  }
+
+  /*! When enabled, new messages don't trigger a Modified event
+    right away.  Instead, a single Modified event is invoked when the
+    ROS node is spun (see vtkMRMLROS2NodeNode::FlushModifiedEvents),
+    with the number of messages received since the last Modified
+    event as call data (int).  This reduces the number of observer
+    calls for high frequency topics.  Default is false. */
+  inline void SetCoalesceModifiedEvents(const bool & coalesce) {
+    mCoalesceModifiedEvents = coalesce;
+  }
+  inline bool GetCoalesceModifiedEvents(void) const {
+    return mCoalesceModifiedEvents;
+  }
+
+  /*! Number of messages received between the last two Modified
+    events triggered by new messages. */
+  inline size_t GetNumberOfMessagesInLastModified(void) const {
+    return mNumberOfMessagesInLastModified;
+  }
+
   /**
    * Get the latest ROS message in YAML format
    */
@@ -69,6 +239,42 @@ class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2SubscriberNode: public vtkMR
   std::string mTopic = "undefined";
   std::string mMRMLNodeName = "ros2:sub:undefined";
   size_t mNumberOfMessages = 0;
+  bool mCoalesceModifiedEvents = false;
+  bool mZeroCopy = false;
+  int mHistoryDepth = 0;
+  int mDecimationEveryNth = 1;
+  double mDecimationMaximumRate = 0.0;
+  double mDecimationMinimumChange = 0.0;
+  vtkMRMLROS2::QoSSettings mQoS{100};
+  bool SetQoS(const vtkMRMLROS2::QoSSettings & qos, const char * context);
+  size_t mNumberOfMessagesSinceModified = 0;
+  size_t mNumberOfMessagesInLastModified = 0;
+  int mDrivenTableRow = -1;
+  size_t mDrivenNodeVersion = 0;
+  std::string mDrivenFrameId;
+
+  /*! Place the driven node in the frame of the latest message, see
+    DriveNode. */
+  void PlaceDrivenNode(vtkMRMLNode * node);
+
+  /*! Called by the ROS node after each spin, updates the driven node
+    if a new message has been received.  Returns true if the node has
+    been updated. */
+  bool UpdateDrivenNode(void);
+  vtkSmartPointer<vtkMRMLROS2TimeStatistics> mCallbackStatistics = vtkSmartPointer<vtkMRMLROS2TimeStatistics>::New();
+  vtkSmartPointer<vtkMRMLROS2TimeStatistics> mConversionStatistics = vtkSmartPointer<vtkMRMLROS2TimeStatistics>::New();
+
+  /*! Called by the ROS node when spinning in background. */
+  bool MoveLatestMessage(void);
+
+  /*! Called by the internals for each new message (or batch of
+    messages when spinning in background).  Either invokes the
+    Modified event or defers it until FlushModifiedEvent. */
+  void MessagesReceived(const size_t & numberOfMessages);
+
+  /*! Invoke the Modified event deferred by MessagesReceived.
+    Returns true if an event was invoked. */
+  bool FlushModifiedEvent(void);
 
   // For ReadXMLAttributes
   inline void SetTopic(const std::string & topic) {
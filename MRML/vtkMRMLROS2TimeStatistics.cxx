@@ -0,0 +1,108 @@
+#include <vtkMRMLROS2TimeStatistics.h>
+
+#include <vtkObjectFactory.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+vtkStandardNewMacro(vtkMRMLROS2TimeStatistics);
+
+
+vtkMRMLROS2TimeStatistics::vtkMRMLROS2TimeStatistics()
+{
+  mSamples.resize(1000);
+}
+
+
+void vtkMRMLROS2TimeStatistics::PrintSelf(std::ostream & os, vtkIndent indent)
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of samples: " << mNumberOfSamples << "\n";
+  os << indent << "Window size: " << mSamples.size() << "\n";
+  os << indent << "Last (ms): " << mLast << "\n";
+  os << indent << "Mean (ms): " << GetMean() << "\n";
+  os << indent << "P50 (ms): " << GetP50() << "\n";
+  os << indent << "P99 (ms): " << GetP99() << "\n";
+  os << indent << "Maximum (ms): " << GetMaximum() << "\n";
+}
+
+
+double vtkMRMLROS2TimeStatistics::Now(void)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+void vtkMRMLROS2TimeStatistics::AddSample(const double & duration)
+{
+  mSamples[mNext] = duration;
+  mNext = (mNext + 1) % mSamples.size();
+  mNumberOfSamples++;
+  mLast = duration;
+}
+
+
+void vtkMRMLROS2TimeStatistics::Reset(void)
+{
+  mNext = 0;
+  mNumberOfSamples = 0;
+  mLast = 0.0;
+}
+
+
+void vtkMRMLROS2TimeStatistics::SetWindowSize(const size_t & size)
+{
+  if (size == 0) {
+    vtkErrorMacro(<< "SetWindowSize: window size must be at least 1");
+    return;
+  }
+  mSamples.resize(size);
+  Reset();
+}
+
+
+size_t vtkMRMLROS2TimeStatistics::GetNumberOfSamplesInWindow(void) const
+{
+  return std::min(mNumberOfSamples, mSamples.size());
+}
+
+
+double vtkMRMLROS2TimeStatistics::GetPercentile(const double & percentile)
+{
+  const size_t nbSamples = GetNumberOfSamplesInWindow();
+  if (nbSamples == 0) {
+    return 0.0;
+  }
+  // oldest samples are overwritten first so the first nbSamples are always valid
+  mSorted.assign(mSamples.begin(), mSamples.begin() + nbSamples);
+  const double clamped = std::min(100.0, std::max(0.0, percentile));
+  const size_t index = std::min(nbSamples - 1,
+                                static_cast<size_t>(std::ceil(clamped / 100.0 * nbSamples)) - (clamped > 0.0 ? 1 : 0));
+  std::nth_element(mSorted.begin(), mSorted.begin() + index, mSorted.end());
+  return mSorted[index];
+}
+
+
+double vtkMRMLROS2TimeStatistics::GetMaximum(void) const
+{
+  const size_t nbSamples = GetNumberOfSamplesInWindow();
+  if (nbSamples == 0) {
+    return 0.0;
+  }
+  return *std::max_element(mSamples.begin(), mSamples.begin() + nbSamples);
+}
+
+
+double vtkMRMLROS2TimeStatistics::GetMean(void) const
+{
+  const size_t nbSamples = GetNumberOfSamplesInWindow();
+  if (nbSamples == 0) {
+    return 0.0;
+  }
+  double sum = 0.0;
+  for (size_t i = 0; i < nbSamples; ++i) {
+    sum += mSamples[i];
+  }
+  return sum / static_cast<double>(nbSamples);
+}
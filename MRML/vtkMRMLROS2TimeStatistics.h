@@ -0,0 +1,76 @@
+#ifndef __vtkMRMLROS2TimeStatistics_h
+#define __vtkMRMLROS2TimeStatistics_h
+
+#include <vtkObject.h>
+
+#include <vtkSlicerROS2ModuleMRMLExport.h>
+
+#include <vector>
+
+/*! Rolling statistics for durations, used to profile the ROS spin
+  loop.  All durations are in milliseconds.  Samples are kept in a
+  circular buffer (see SetWindowSize) so percentiles and maximum only
+  reflect the latest samples. */
+class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2TimeStatistics: public vtkObject
+{
+ public:
+  vtkTypeMacro(vtkMRMLROS2TimeStatistics, vtkObject);
+  static vtkMRMLROS2TimeStatistics * New(void);
+  void PrintSelf(std::ostream & os, vtkIndent indent) override;
+
+  /*! Current time in milliseconds using a monotonic clock.  Use the
+    difference between two calls to compute a duration. */
+  static double Now(void);
+
+  /*! Add a duration, in milliseconds. */
+  void AddSample(const double & duration);
+
+  /*! Remove all samples. */
+  void Reset(void);
+
+  /*! Number of samples used to compute the statistics.  Changing the
+    window size resets the statistics.  Default is 1000. */
+  void SetWindowSize(const size_t & size);
+  inline size_t GetWindowSize(void) const {
+    return mSamples.size();
+  }
+
+  /*! Total number of samples added since last reset, including the
+    ones no longer in the window. */
+  inline size_t GetNumberOfSamples(void) const {
+    return mNumberOfSamples;
+  }
+
+  /*! Percentile (0 to 100) over the samples in the window, 0 if there
+    are no samples. */
+  double GetPercentile(const double & percentile);
+  inline double GetP50(void) {
+    return GetPercentile(50.0);
+  }
+  inline double GetP99(void) {
+    return GetPercentile(99.0);
+  }
+  double GetMaximum(void) const;
+  double GetMean(void) const;
+  inline double GetLast(void) const {
+    return mLast;
+  }
+
+ protected:
+  vtkMRMLROS2TimeStatistics();
+  ~vtkMRMLROS2TimeStatistics() override = default;
+
+  size_t GetNumberOfSamplesInWindow(void) const;
+
+  std::vector<double> mSamples;
+  std::vector<double> mSorted; // to avoid allocations when computing percentiles
+  size_t mNext = 0;
+  size_t mNumberOfSamples = 0;
+  double mLast = 0.0;
+
+ private:
+  vtkMRMLROS2TimeStatistics(const vtkMRMLROS2TimeStatistics &); // Not implemented
+  void operator=(const vtkMRMLROS2TimeStatistics &); // Not implemented
+};
+
+#endif // __vtkMRMLROS2TimeStatistics_h
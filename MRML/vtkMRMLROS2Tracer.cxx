@@ -0,0 +1,303 @@
+#include <vtkMRMLROS2Tracer.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace {
+
+  struct TraceEvent {
+    char mPhase;
+    std::string mCategory;
+    std::string mName;
+    int64_t mTimeStamp; // in microseconds
+    size_t mThreadId;
+  };
+
+  struct TraceData {
+    std::atomic<bool> mRecording{false};
+    std::mutex mMutex;
+    std::string mFileName;
+    std::vector<TraceEvent> mEvents; // capacity set by Start, never reallocated
+    size_t mNumberOfDroppedEvents = 0;
+    size_t mNumberOfOpenScopes = 0; // begin events recorded without their end event yet
+    size_t mSession = 0; // incremented by Start, 0 is used for events not recorded
+    std::chrono::steady_clock::time_point mStart;
+  };
+
+  TraceData & GetTraceData(void)
+  {
+    static TraceData data;
+    return data;
+  }
+
+  size_t GetThreadId(void)
+  {
+    // small, stable ids so threads are easy to read in the trace viewer
+    static std::atomic<size_t> nextId{1};
+    thread_local const size_t id = nextId.fetch_add(1);
+    return id;
+  }
+
+  int64_t GetTimeStamp(const TraceData & data, const std::chrono::steady_clock::time_point & time)
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time - data.mStart).count();
+  }
+
+  // returns the session the begin event was recorded in, 0 if dropped
+  size_t AddBeginEvent(const std::string & category, const std::string & name)
+  {
+    TraceData & data = GetTraceData();
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(data.mMutex);
+    if (!data.mRecording) {
+      return 0;
+    }
+    // keep room for the end events of all open scopes, including this one
+    if (data.mEvents.size() + data.mNumberOfOpenScopes + 2 > data.mEvents.capacity()) {
+      data.mNumberOfDroppedEvents++;
+      return 0;
+    }
+    data.mEvents.push_back({'B', category, name, GetTimeStamp(data, now), GetThreadId()});
+    data.mNumberOfOpenScopes++;
+    return data.mSession;
+  }
+
+  // only records the end event if its begin event was recorded in the current session
+  void AddEndEvent(const size_t session, const std::string & category, const std::string & name)
+  {
+    if (session == 0) {
+      return;
+    }
+    TraceData & data = GetTraceData();
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(data.mMutex);
+    if (!data.mRecording || (data.mSession != session)) {
+      return;
+    }
+    data.mEvents.push_back({'E', category, name, GetTimeStamp(data, now), GetThreadId()});
+    data.mNumberOfOpenScopes--;
+  }
+
+  // sessions of the begin events recorded with vtkMRMLROS2Tracer::Begin on this thread
+  std::vector<size_t> & GetThreadOpenScopes(void)
+  {
+    thread_local std::vector<size_t> openScopes;
+    return openScopes;
+  }
+
+  // add end events for the scopes still open when the recording stopped
+  void CloseOpenScopes(std::vector<TraceEvent> & events, const int64_t timeStamp)
+  {
+    std::map<size_t, std::vector<size_t>> openScopes; // per thread, indices of begin events
+    for (size_t index = 0; index < events.size(); ++index) {
+      auto & stack = openScopes[events[index].mThreadId];
+      if (events[index].mPhase == 'B') {
+        stack.push_back(index);
+      } else if (!stack.empty()) {
+        stack.pop_back();
+      }
+    }
+    for (auto & threadScopes : openScopes) {
+      auto & stack = threadScopes.second;
+      while (!stack.empty()) {
+        const TraceEvent & begin = events[stack.back()];
+        events.push_back({'E', begin.mCategory, begin.mName, timeStamp, begin.mThreadId});
+        stack.pop_back();
+      }
+    }
+  }
+
+  void WriteEscaped(std::ostream & out, const std::string & text)
+  {
+    for (const char c : text) {
+      switch (c) {
+      case '"':  out << "\\\""; break;
+      case '\\': out << "\\\\"; break;
+      case '\n': out << "\\n"; break;
+      case '\t': out << "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) >= 0x20) {
+          out << c;
+        }
+      }
+    }
+  }
+
+  int GetProcessId(void)
+  {
+#ifdef __linux__
+    return static_cast<int>(getpid());
+#else
+    return 1;
+#endif
+  }
+}
+
+
+bool vtkMRMLROS2Tracer::Start(const std::string & fileName, const size_t & maximumNumberOfEvents,
+                              std::string & errorMessage)
+{
+  TraceData & data = GetTraceData();
+  std::lock_guard<std::mutex> lock(data.mMutex);
+  if (data.mRecording) {
+    errorMessage = "already recording to \"" + data.mFileName + "\"";
+    return false;
+  }
+  if (maximumNumberOfEvents == 0) {
+    errorMessage = "maximum number of events must be strictly positive";
+    return false;
+  }
+  data.mFileName = fileName;
+  // release the previous buffer so the capacity is exactly the one requested
+  std::vector<TraceEvent>().swap(data.mEvents);
+  try {
+    data.mEvents.reserve(maximumNumberOfEvents);
+  } catch (std::exception & e) {
+    errorMessage = "unable to allocate " + std::to_string(maximumNumberOfEvents)
+      + " events, " + e.what();
+    return false;
+  }
+  data.mNumberOfDroppedEvents = 0;
+  data.mNumberOfOpenScopes = 0;
+  data.mSession++;
+  data.mStart = std::chrono::steady_clock::now();
+  data.mRecording = true;
+  return true;
+}
+
+
+bool vtkMRMLROS2Tracer::Stop(std::string & errorMessage)
+{
+  TraceData & data = GetTraceData();
+  std::vector<TraceEvent> events;
+  std::string fileName;
+  size_t numberOfDroppedEvents;
+  int64_t stopTimeStamp;
+  {
+    std::lock_guard<std::mutex> lock(data.mMutex);
+    if (!data.mRecording) {
+      errorMessage = "not recording";
+      return false;
+    }
+    data.mRecording = false;
+    stopTimeStamp = GetTimeStamp(data, std::chrono::steady_clock::now());
+    events.swap(data.mEvents);
+    fileName = data.mFileName;
+    numberOfDroppedEvents = data.mNumberOfDroppedEvents;
+  }
+  // room for these was reserved when the begin events were recorded
+  CloseOpenScopes(events, stopTimeStamp);
+
+  std::ofstream out(fileName);
+  if (!out.is_open()) {
+    errorMessage = "unable to open \"" + fileName + "\"";
+    return false;
+  }
+  const int pid = GetProcessId();
+  out << "{\"traceEvents\":[\n";
+  bool first = true;
+  for (const auto & event : events) {
+    if (!first) {
+      out << ",\n";
+    }
+    first = false;
+    out << "{\"ph\":\"" << event.mPhase
+        << "\",\"cat\":\"";
+    WriteEscaped(out, event.mCategory);
+    out << "\",\"name\":\"";
+    WriteEscaped(out, event.mName);
+    out << "\",\"ts\":" << event.mTimeStamp
+        << ",\"pid\":" << pid
+        << ",\"tid\":" << event.mThreadId << "}";
+  }
+  out << "\n],\"displayTimeUnit\":\"ms\""
+      << ",\"otherData\":{\"droppedEvents\":\"" << numberOfDroppedEvents << "\"}}\n";
+  if (!out.good()) {
+    errorMessage = "error while writing \"" + fileName + "\"";
+    return false;
+  }
+  return true;
+}
+
+
+bool vtkMRMLROS2Tracer::IsRecording(void)
+{
+  return GetTraceData().mRecording.load(std::memory_order_relaxed);
+}
+
+
+size_t vtkMRMLROS2Tracer::GetNumberOfDroppedEvents(void)
+{
+  TraceData & data = GetTraceData();
+  std::lock_guard<std::mutex> lock(data.mMutex);
+  return data.mNumberOfDroppedEvents;
+}
+
+
+void vtkMRMLROS2Tracer::Begin(const std::string & category, const std::string & name)
+{
+  // always push so End can pop the matching entry, even if recording
+  // started or stopped in between
+  GetThreadOpenScopes().push_back(IsRecording() ? AddBeginEvent(category, name) : 0);
+}
+
+
+void vtkMRMLROS2Tracer::End(const std::string & category, const std::string & name)
+{
+  auto & openScopes = GetThreadOpenScopes();
+  if (openScopes.empty()) {
+    return;
+  }
+  const size_t session = openScopes.back();
+  openScopes.pop_back();
+  AddEndEvent(session, category, name);
+}
+
+
+vtkMRMLROS2Tracer::Scope::Scope(const char * category, const char * name):
+  mCategory(category),
+  mSession(0)
+{
+  if (IsRecording()) {
+    mName = name;
+    mSession = AddBeginEvent(mCategory, mName);
+  }
+}
+
+
+vtkMRMLROS2Tracer::Scope::Scope(const char * category, const char * name, const std::string & detail):
+  mCategory(category),
+  mSession(0)
+{
+  if (IsRecording()) {
+    mName = std::string(name) + " " + detail;
+    mSession = AddBeginEvent(mCategory, mName);
+  }
+}
+
+
+vtkMRMLROS2Tracer::Scope::Scope(const char * category, const char * name, const std::string & detail,
+                                 const std::string & secondDetail):
+  mCategory(category),
+  mSession(0)
+{
+  if (IsRecording()) {
+    mName = std::string(name) + " " + detail + " -> " + secondDetail;
+    mSession = AddBeginEvent(mCategory, mName);
+  }
+}
+
+
+vtkMRMLROS2Tracer::Scope::~Scope()
+{
+  // if the begin event was dropped or recording stopped in between, the end event is dropped
+  AddEndEvent(mSession, mCategory, mName);
+}
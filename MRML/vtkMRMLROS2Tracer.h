@@ -0,0 +1,63 @@
+#ifndef __vtkMRMLROS2Tracer_h
+#define __vtkMRMLROS2Tracer_h
+
+#include <string>
+#include <cstddef>
+
+#include <vtkSlicerROS2ModuleMRMLExport.h>
+
+/*! Records begin/end events in the Chrome trace event format (JSON),
+  which can be opened with Perfetto (https://ui.perfetto.dev) or
+  chrome://tracing.  Recording is global to the process and disabled
+  by default.  When disabled, a Scope only costs an atomic load. */
+class VTK_SLICER_ROS2_MODULE_MRML_EXPORT vtkMRMLROS2Tracer
+{
+ public:
+  /*! Start recording events, the events are written to fileName
+    when Stop is called.  The memory for maximumNumberOfEvents events
+    is allocated once, events recorded after the buffer is full are
+    dropped (see GetNumberOfDroppedEvents).  Room is kept for the end
+    events of the recorded begin events so a full buffer never leaves
+    unterminated slices.  Returns false if already recording. */
+  static bool Start(const std::string & fileName, const size_t & maximumNumberOfEvents,
+                    std::string & errorMessage);
+
+  /*! Stop recording and write the trace file.  Returns false if not
+    recording or if the file can't be written. */
+  static bool Stop(std::string & errorMessage);
+
+  static bool IsRecording(void);
+
+  /*! Number of begin events dropped because the buffer was full,
+    for the current or last recording.  Their end events are dropped
+    as well and not counted.  The count is also saved in the trace
+    file metadata. */
+  static size_t GetNumberOfDroppedEvents(void);
+
+  /*! Begin and End must be nested on each thread, End closes the
+    last Begin of the calling thread.  Scopes still open when Stop is
+    called are closed at the stop time. */
+  static void Begin(const std::string & category, const std::string & name);
+  static void End(const std::string & category, const std::string & name);
+
+  /*! Record a begin event when created and the matching end event
+    when deleted.  The name is only built if recording, the second
+    detail can be used for pairs such as "parent -> child". */
+  class Scope
+  {
+  public:
+    Scope(const char * category, const char * name);
+    Scope(const char * category, const char * name, const std::string & detail);
+    Scope(const char * category, const char * name, const std::string & detail,
+          const std::string & secondDetail);
+    ~Scope();
+    Scope(const Scope &) = delete;
+    Scope & operator = (const Scope &) = delete;
+  protected:
+    const char * mCategory;
+    std::string mName;
+    size_t mSession; // 0 if the begin event was not recorded
+  };
+};
+
+#endif // __vtkMRMLROS2Tracer_h
@@ -5,6 +5,11 @@
 
 #include <rclcpp/rclcpp.hpp>
 
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
 
 bool vtkMRMLROS2::ROSInit(void)
 {
@@ -49,3 +54,99 @@ vtkMRMLROS2NodeNode * vtkMRMLROS2::CheckROS2NodeExists(vtkMRMLNode * nodeInScene
   }
   return rosNodePtr;
 }
+
+
+bool vtkMRMLROS2::CheckQoSSettings(const QoSSettings & settings, std::string & errorMessage)
+{
+  if ((settings.History != "keep_last") && (settings.History != "keep_all")) {
+    errorMessage = "invalid history \"" + settings.History + "\", must be \"keep_last\" or \"keep_all\"";
+    return false;
+  }
+  if (settings.Depth < 1) {
+    errorMessage = "invalid depth " + std::to_string(settings.Depth) + ", must be at least 1";
+    return false;
+  }
+  if ((settings.Reliability != "reliable") && (settings.Reliability != "best_effort")) {
+    errorMessage = "invalid reliability \"" + settings.Reliability + "\", must be \"reliable\" or \"best_effort\"";
+    return false;
+  }
+  if ((settings.Durability != "volatile") && (settings.Durability != "transient_local")) {
+    errorMessage = "invalid durability \"" + settings.Durability + "\", must be \"volatile\" or \"transient_local\"";
+    return false;
+  }
+  if ((settings.Deadline < 0.0) || (settings.Lifespan < 0.0)) {
+    errorMessage = "deadline and lifespan can't be negative";
+    return false;
+  }
+  return true;
+}
+
+
+rclcpp::QoS vtkMRMLROS2::ToROS2QoS(const QoSSettings & settings)
+{
+  rclcpp::QoS qos = (settings.History == "keep_all")
+    ? rclcpp::QoS(rclcpp::KeepAll())
+    : rclcpp::QoS(rclcpp::KeepLast(settings.Depth));
+  if (settings.Reliability == "best_effort") {
+    qos.best_effort();
+  } else {
+    qos.reliable();
+  }
+  if (settings.Durability == "transient_local") {
+    qos.transient_local();
+  } else {
+    qos.durability_volatile();
+  }
+  if (settings.Deadline > 0.0) {
+    qos.deadline(rclcpp::Duration::from_seconds(settings.Deadline));
+  }
+  if (settings.Lifespan > 0.0) {
+    qos.lifespan(rclcpp::Duration::from_seconds(settings.Lifespan));
+  }
+  return qos;
+}
+
+
+bool vtkMRMLROS2::QoSAllowsIntraProcess(const QoSSettings & settings)
+{
+  return (settings.History == "keep_last") && (settings.Durability == "volatile");
+}
+
+
+int vtkMRMLROS2::GetWakeupFileDescriptor(void)
+{
+#ifdef __linux__
+  static const int fileDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  return fileDescriptor;
+#else
+  return -1;
+#endif
+}
+
+
+void vtkMRMLROS2::NotifyWakeup(void)
+{
+#ifdef __linux__
+  const int fileDescriptor = GetWakeupFileDescriptor();
+  if (fileDescriptor >= 0) {
+    const uint64_t increment = 1;
+    // can only fail if the counter overflows, it is then readable anyway
+    ssize_t written = write(fileDescriptor, &increment, sizeof(increment));
+    (void)written;
+  }
+#endif
+}
+
+
+void vtkMRMLROS2::ClearWakeup(void)
+{
+#ifdef __linux__
+  const int fileDescriptor = GetWakeupFileDescriptor();
+  if (fileDescriptor >= 0) {
+    uint64_t counter;
+    // non blocking, fails with EAGAIN if there was nothing to read
+    ssize_t bytesRead = read(fileDescriptor, &counter, sizeof(counter));
+    (void)bytesRead;
+  }
+#endif
+}
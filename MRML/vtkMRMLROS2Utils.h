@@ -6,6 +6,9 @@
 // forward declarations
 class vtkMRMLNode;
 class vtkMRMLROS2NodeNode;
+namespace rclcpp {
+  class QoS;
+}
 
 #include <vtkSlicerROS2ModuleMRMLExport.h>
 
@@ -13,6 +16,39 @@ namespace vtkMRMLROS2 {
   bool ROSInit(void);
   void ROSShutdown(void);
   vtkMRMLROS2NodeNode * CheckROS2NodeExists(vtkMRMLNode * node, const char * nodeId, std::string & errorMessage);
+
+  /*! File descriptor that becomes readable when ROS data received by
+    a background thread is waiting to be moved to MRML.  This allows
+    to wake up the application's event loop (e.g. with a
+    QSocketNotifier).  Returns -1 if not supported on this platform. */
+  int GetWakeupFileDescriptor(void);
+  /*! Make the wakeup file descriptor readable, can be called from any thread. */
+  void NotifyWakeup(void);
+  /*! Reset the wakeup file descriptor, called before spinning. */
+  void ClearWakeup(void);
+
+  /*! QoS used by subscribers and publishers, stored as strings so
+    they can be saved in the MRML scene.  History is "keep_last" or
+    "keep_all", reliability is "reliable" or "best_effort" and
+    durability is "volatile" or "transient_local".  Deadline and
+    lifespan are in seconds, 0 means default (infinite). */
+  struct QoSSettings {
+    QoSSettings(const int & depth):
+      Depth(depth)
+    {}
+    std::string History = "keep_last";
+    int Depth;
+    std::string Reliability = "reliable";
+    std::string Durability = "volatile";
+    double Deadline = 0.0;
+    double Lifespan = 0.0;
+  };
+
+  bool CheckQoSSettings(const QoSSettings & settings, std::string & errorMessage);
+  rclcpp::QoS ToROS2QoS(const QoSSettings & settings);
+  /*! rclcpp intra-process communications only support volatile
+    durability and keep last history. */
+  bool QoSAllowsIntraProcess(const QoSSettings & settings);
 }
 
 #endif // __vtkMRMLROS2Utils_h
@@ -0,0 +1,79 @@
+#include <vtkMRMLToSlicer.h>
+
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+
+#include <vtkMRMLTableNode.h>
+#include <vtkMRMLTextNode.h>
+#include <vtkMRMLTransformNode.h>
+#include <vtkMRMLVolumeNode.h>
+
+
+bool vtkMRMLToSlicer(vtkMRMLNode * input, std::string & result, std::string & errorMessage)
+{
+  vtkMRMLTextNode * textNode = vtkMRMLTextNode::SafeDownCast(input);
+  if (!textNode) {
+    errorMessage = std::string("expected a vtkMRMLTextNode, got ") + input->GetClassName();
+    return false;
+  }
+  result = textNode->GetText() ? textNode->GetText() : "";
+  return true;
+}
+
+
+bool vtkMRMLToSlicer(vtkMRMLNode * input, vtkMatrix4x4 * result, std::string & errorMessage)
+{
+  vtkMRMLTransformNode * transformNode = vtkMRMLTransformNode::SafeDownCast(input);
+  if (!transformNode) {
+    errorMessage = std::string("expected a vtkMRMLTransformNode, got ") + input->GetClassName();
+    return false;
+  }
+  if (!transformNode->IsLinear()) {
+    errorMessage = std::string("transform \"") + (input->GetName() ? input->GetName() : "") + "\" is not linear";
+    return false;
+  }
+  transformNode->GetMatrixTransformToParent(result);
+  return true;
+}
+
+
+bool vtkMRMLToSlicer(vtkMRMLNode * input, vtkTable * result, std::string & errorMessage)
+{
+  vtkMRMLTableNode * tableNode = vtkMRMLTableNode::SafeDownCast(input);
+  if (!tableNode || !tableNode->GetTable()) {
+    errorMessage = std::string("expected a vtkMRMLTableNode with a table, got ") + input->GetClassName();
+    return false;
+  }
+  result->ShallowCopy(tableNode->GetTable());
+  return true;
+}
+
+
+bool vtkMRMLToSlicer(vtkMRMLNode * input, vtkTypeUInt8Array * result, std::string & errorMessage)
+{
+  vtkMRMLVolumeNode * volumeNode = vtkMRMLVolumeNode::SafeDownCast(input);
+  if (!volumeNode || !volumeNode->GetImageData()
+      || !volumeNode->GetImageData()->GetPointData()->GetScalars()) {
+    errorMessage = std::string("expected a vtkMRMLVolumeNode with image data, got ") + input->GetClassName();
+    return false;
+  }
+  vtkDataArray * scalars = volumeNode->GetImageData()->GetPointData()->GetScalars();
+  if (scalars->GetDataType() != VTK_UNSIGNED_CHAR) {
+    errorMessage = std::string("volume \"") + (input->GetName() ? input->GetName() : "") + "\" scalars must be unsigned char";
+    return false;
+  }
+  result->ShallowCopy(scalars);
+  return true;
+}
+
+
+bool vtkMRMLToSlicer(vtkMRMLNode * input, vtkImageData * result, std::string & errorMessage)
+{
+  vtkMRMLVolumeNode * volumeNode = vtkMRMLVolumeNode::SafeDownCast(input);
+  if (!volumeNode || !volumeNode->GetImageData()) {
+    errorMessage = std::string("expected a vtkMRMLVolumeNode with image data, got ") + input->GetClassName();
+    return false;
+  }
+  result->ShallowCopy(volumeNode->GetImageData());
+  return true;
+}
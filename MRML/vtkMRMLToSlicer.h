@@ -0,0 +1,41 @@
+#ifndef __vtkMRMLToSlicer_h
+#define __vtkMRMLToSlicer_h
+
+#include <string>
+
+// VTK
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkTable.h>
+#include <vtkTypeUInt8Array.h>
+
+// MRML
+#include <vtkMRMLNode.h>
+
+/*! Conversions from MRML nodes to the Slicer types used by
+  publishers, used to publish the content of an observed MRML node
+  (see vtkMRMLROS2PublisherNode::ObserveNode).  VTK results are
+  shallow copies when possible.  Return false and set the error
+  message if the MRML node is not of the expected class. */
+bool vtkMRMLToSlicer(vtkMRMLNode * input, std::string & result, std::string & errorMessage);
+bool vtkMRMLToSlicer(vtkMRMLNode * input, vtkMatrix4x4 * result, std::string & errorMessage);
+bool vtkMRMLToSlicer(vtkMRMLNode * input, vtkTable * result, std::string & errorMessage);
+bool vtkMRMLToSlicer(vtkMRMLNode * input, vtkTypeUInt8Array * result, std::string & errorMessage);
+bool vtkMRMLToSlicer(vtkMRMLNode * input, vtkImageData * result, std::string & errorMessage);
+
+// for all other types
+template <typename _slicer_type>
+bool vtkMRMLToSlicer(vtkMRMLNode * input, _slicer_type & vtkNotUsed(result), std::string & errorMessage)
+{
+  errorMessage = std::string("publishing a ") + input->GetClassName() + " is not supported for this publisher type";
+  return false;
+}
+
+template <typename _slicer_type>
+bool vtkMRMLToSlicer(vtkMRMLNode * input, _slicer_type * vtkNotUsed(result), std::string & errorMessage)
+{
+  errorMessage = std::string("publishing a ") + input->GetClassName() + " is not supported for this publisher type";
+  return false;
+}
+
+#endif // __vtkMRMLToSlicer_h
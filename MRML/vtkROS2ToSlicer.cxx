@@ -1,10 +1,249 @@
 #include <vtkROS2ToSlicer.h>
+#include <algorithm>
+#include <type_traits>
+#include <vtkNew.h>
 #include <vtkMath.h>
+#include <vtkPointData.h>
+#include <vtkByteSwap.h>
+#include <vtkEndian.h> // VTK_WORDS_BIGENDIAN
 #include <vtkVariant.h>
 
 
 auto const MM_TO_M_CONVERSION = 1000.00;
 
+namespace {
+
+  /*! Make sure the table has the given number of rows and columns,
+    all columns of type _array_type.  The existing columns are reused
+    so the memory is only reallocated when the shape changes. */
+  template <typename _array_type>
+  void ResizeTable(vtkTable * table, const vtkIdType & numberOfRows, const vtkIdType & numberOfColumns)
+  {
+    for (vtkIdType column = 0; column < table->GetNumberOfColumns(); ++column) {
+      _array_type * array = _array_type::FastDownCast(table->GetColumn(column));
+      if ((array == nullptr) || (array->GetNumberOfComponents() != 1)) {
+        // unexpected content, start from scratch
+        table->Initialize();
+        break;
+      }
+    }
+    while (table->GetNumberOfColumns() > numberOfColumns) {
+      table->RemoveColumn(table->GetNumberOfColumns() - 1);
+    }
+    while (table->GetNumberOfColumns() < numberOfColumns) {
+      vtkNew<_array_type> column;
+      table->AddColumn(column);
+    }
+    for (vtkIdType column = 0; column < numberOfColumns; ++column) {
+      table->GetColumn(column)->SetNumberOfTuples(numberOfRows);
+    }
+  }
+
+  /*! Layouts with "column" or "columns" as label of the first
+    dimension are column major, i.e. the values of each column are
+    contiguous.  Otherwise the layout is row major. */
+  bool IsColumnMajor(const std_msgs::msg::MultiArrayLayout & layout)
+  {
+    return ((layout.dim[0].label == "column") || (layout.dim[0].label == "columns"));
+  }
+
+  template <typename _array_type, typename _value_type>
+  void MultiArrayToTable(const std::vector<_value_type> & data,
+                         const std_msgs::msg::MultiArrayLayout & layout,
+                         vtkTable * result)
+  {
+    // if input is not a 2D array raise an error
+    if (layout.dim.size() != 2){
+      std::cerr << "Input is not a 2D array" << std::endl;
+      return;
+    }
+    const bool columnMajor = IsColumnMajor(layout);
+    const vtkIdType numRows = columnMajor ? layout.dim[1].size : layout.dim[0].size;
+    const vtkIdType numCols = columnMajor ? layout.dim[0].size : layout.dim[1].size;
+    if (data.size() < layout.data_offset + static_cast<size_t>(numRows * numCols)) {
+      std::cerr << "Input data is smaller than its layout" << std::endl;
+      return;
+    }
+    // the result is cached and reused by the subscribers, update it in place
+    ResizeTable<_array_type>(result, numRows, numCols);
+    const _value_type * source = data.data() + layout.data_offset;
+    for (vtkIdType i = 0; i < numCols; i++){
+      auto * column = _array_type::FastDownCast(result->GetColumn(i))->GetPointer(0);
+      if (columnMajor) {
+        std::copy(source + i * numRows, source + (i + 1) * numRows, column);
+      } else {
+        for (vtkIdType j = 0; j < numRows; j++){
+          column[j] = source[j * numCols + i];
+        }
+      }
+    }
+    result->Modified();
+  }
+
+  /*! Sizes and element steps of a MultiArray layout.  The step of
+    dimension k is the stride of dimension k + 1, 1 for the last
+    dimension.  Strides left to 0 are considered dense since many
+    publishers don't set them.  Returns false if the layout doesn't
+    fit in the data. */
+  template <typename _value_type>
+  bool GetMultiArrayLayout(const std::vector<_value_type> & data,
+                           const std_msgs::msg::MultiArrayLayout & layout,
+                           std::vector<size_t> & sizes,
+                           std::vector<size_t> & steps,
+                           bool & dense)
+  {
+    const size_t numberOfDimensions = layout.dim.size();
+    sizes.resize(numberOfDimensions);
+    steps.resize(numberOfDimensions);
+    dense = true;
+    size_t last = 0; // offset of the last element
+    bool empty = false;
+    for (size_t k = numberOfDimensions; k-- > 0; ) {
+      sizes[k] = layout.dim[k].size;
+      if (k == numberOfDimensions - 1) {
+        steps[k] = 1;
+      } else {
+        const size_t denseStep = sizes[k + 1] * steps[k + 1];
+        const size_t stride = layout.dim[k + 1].stride;
+        if ((stride != 0) && (stride < denseStep)) {
+          std::cerr << "Invalid stride for dimension " << k + 1 << std::endl;
+          return false;
+        }
+        steps[k] = (stride == 0) ? denseStep : stride;
+        dense = dense && (steps[k] == denseStep);
+      }
+      if (sizes[k] == 0) {
+        empty = true;
+      } else {
+        last += (sizes[k] - 1) * steps[k];
+      }
+    }
+    if (!empty && (data.size() <= layout.data_offset + last)) {
+      std::cerr << "Input data is smaller than its layout" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  /*! Copy all the elements of a MultiArray in a dense buffer, last
+    dimension first.  Uses one bulk copy if the layout is dense, one
+    bulk copy per row (last dimension) otherwise. */
+  template <typename _value_type, typename _output_type>
+  void CopyMultiArray(const std::vector<_value_type> & data,
+                      const std_msgs::msg::MultiArrayLayout & layout,
+                      const std::vector<size_t> & sizes,
+                      const std::vector<size_t> & steps,
+                      const bool & dense,
+                      _output_type * output)
+  {
+    size_t numberOfElements = 1;
+    for (const auto & size : sizes) {
+      numberOfElements *= size;
+    }
+    if ((numberOfElements == 0) || sizes.empty()) {
+      return;
+    }
+    const _value_type * source = data.data() + layout.data_offset;
+    if (dense) {
+      std::copy(source, source + numberOfElements, output);
+      return;
+    }
+    const size_t rowSize = sizes.back();
+    const size_t numberOfRows = numberOfElements / rowSize;
+    std::vector<size_t> index(sizes.size(), 0);
+    size_t offset = 0;
+    for (size_t row = 0; row < numberOfRows; ++row) {
+      std::copy(source + offset, source + offset + rowSize, output);
+      output += rowSize;
+      // increment the index of the outer dimensions
+      for (size_t k = sizes.size() - 1; k-- > 0; ) {
+        index[k]++;
+        offset += steps[k];
+        if (index[k] < sizes[k]) {
+          break;
+        }
+        offset -= index[k] * steps[k];
+        index[k] = 0;
+      }
+    }
+  }
+
+  /*! The last dimension is used for the components if its label is
+    "component(s)" or "channel(s)". */
+  bool IsComponentDimension(const std_msgs::msg::MultiArrayDimension & dimension)
+  {
+    return ((dimension.label == "component") || (dimension.label == "components")
+            || (dimension.label == "channel") || (dimension.label == "channels"));
+  }
+
+  /*! 1D layouts are converted to single component arrays, 2D layouts
+    to arrays with one tuple per row and one component per column. */
+  template <typename _array_type, typename _value_type>
+  void MultiArrayToDataArray(const std::vector<_value_type> & data,
+                             const std_msgs::msg::MultiArrayLayout & layout,
+                             _array_type * result)
+  {
+    // if input is not a 1D or 2D array raise an error
+    if ((layout.dim.size() != 1) && (layout.dim.size() != 2)) {
+      std::cerr << "Input is not a 1D or 2D array" << std::endl;
+      return;
+    }
+    std::vector<size_t> sizes, steps;
+    bool dense;
+    if (!GetMultiArrayLayout(data, layout, sizes, steps, dense)) {
+      return;
+    }
+    const int numberOfComponents = (sizes.size() == 2) ? sizes[1] : 1;
+    result->SetNumberOfComponents(numberOfComponents < 1 ? 1 : numberOfComponents);
+    result->SetNumberOfTuples(sizes[0]);
+    // bulk copy, the compiler can vectorize the int64 to int conversion
+    CopyMultiArray(data, layout, sizes, steps, dense, result->GetPointer(0));
+    result->Modified();
+  }
+
+  /*! Up to 3 spatial dimensions, the last one is x.  The last
+    dimension is used for the components if the layout has 4
+    dimensions or if its label says so. */
+  template <typename _value_type>
+  void MultiArrayToImageData(const std::vector<_value_type> & data,
+                             const std_msgs::msg::MultiArrayLayout & layout,
+                             const int & scalarType,
+                             vtkImageData * result)
+  {
+    const size_t numberOfDimensions = layout.dim.size();
+    const bool hasComponents = (numberOfDimensions == 4)
+      || ((numberOfDimensions > 1) && IsComponentDimension(layout.dim.back()));
+    const size_t numberOfSpatialDimensions = hasComponents ? numberOfDimensions - 1 : numberOfDimensions;
+    if ((numberOfDimensions == 0) || (numberOfSpatialDimensions > 3)) {
+      std::cerr << "Input is not a 1D, 2D, 3D or 4D array" << std::endl;
+      return;
+    }
+    std::vector<size_t> sizes, steps;
+    bool dense;
+    if (!GetMultiArrayLayout(data, layout, sizes, steps, dense)) {
+      return;
+    }
+    int dimensions[3] = {1, 1, 1};
+    for (size_t k = 0; k < numberOfSpatialDimensions; ++k) {
+      dimensions[k] = sizes[numberOfSpatialDimensions - 1 - k];
+    }
+    const int numberOfComponents = hasComponents ? sizes.back() : 1;
+    result->SetDimensions(dimensions);
+    if (result->GetNumberOfPoints() == 0 || numberOfComponents == 0) {
+      result->Initialize();
+      return;
+    }
+    // reuses the existing scalars if the type matches
+    result->AllocateScalars(scalarType, numberOfComponents);
+    vtkDataArray * scalars = result->GetPointData()->GetScalars();
+    CopyMultiArray(data, layout, sizes, steps, dense,
+                   static_cast<typename std::conditional<std::is_floating_point<_value_type>::value,
+                   double, vtkTypeInt64>::type *>(scalars->GetVoidPointer(0)));
+    scalars->Modified();
+    result->Modified();
+  }
+}
+
 void vtkROS2ToSlicer(const std_msgs::msg::String & input, std::string & result)
 {
   result = input.data;
@@ -27,81 +266,135 @@ void vtkROS2ToSlicer(const std_msgs::msg::Float64 & input, double & result)
 
 void vtkROS2ToSlicer(const std_msgs::msg::Int64MultiArray & input, vtkSmartPointer<vtkIntArray> result)
 {
-  int numElements = input.data.size();
-  // if input is not a 1D array raise an error
-  if (input.layout.dim.size() != 1){
-    std::cerr << "Input is not a 1D array" << std::endl;
-    return;
-  }
-  result->SetNumberOfValues(numElements);
-  for (int j = 0; j < numElements; j++){
-    result->SetValue(j, input.data[j]);
-  }
+  MultiArrayToDataArray(input.data, input.layout, result.GetPointer());
 }
 
 void vtkROS2ToSlicer(const std_msgs::msg::Float64MultiArray & input, vtkSmartPointer<vtkDoubleArray> result)
 {
-  int numElements = input.data.size();
-  // if input is not a 1D array raise an error
-  if (input.layout.dim.size() != 1){
-    std::cerr << "Input is not a 1D array" << std::endl;
-    return;
+  MultiArrayToDataArray(input.data, input.layout, result.GetPointer());
+}
+
+bool vtkROS2ToSlicerZeroCopy(const std_msgs::msg::Float64MultiArray & input, vtkDoubleArray * result)
+{
+  // only dense 1D and 2D layouts can be used as is
+  if ((input.layout.dim.size() != 1) && (input.layout.dim.size() != 2)) {
+    return false;
   }
-  result->SetNumberOfValues(numElements);
-  for (int j = 0; j < numElements; j++){
-    result->SetValue(j, input.data[j]);
+  std::vector<size_t> sizes, steps;
+  bool dense;
+  if (!GetMultiArrayLayout(input.data, input.layout, sizes, steps, dense) || !dense) {
+    return false;
   }
+  const size_t numberOfComponents = (sizes.size() == 2) ? sizes[1] : 1;
+  if (numberOfComponents == 0) {
+    return false;
+  }
+  result->SetNumberOfComponents(numberOfComponents);
+  // save = 1, the memory is owned by the ROS message
+  result->SetArray(const_cast<double *>(input.data.data()) + input.layout.data_offset,
+                   static_cast<vtkIdType>(sizes[0] * numberOfComponents), 1);
+  return true;
+}
+
+void vtkROS2ToSlicer(const std_msgs::msg::Int64MultiArray & input, vtkSmartPointer<vtkImageData> result)
+{
+  MultiArrayToImageData(input.data, input.layout, VTK_TYPE_INT64, result);
+}
+
+void vtkROS2ToSlicer(const std_msgs::msg::Float64MultiArray & input, vtkSmartPointer<vtkImageData> result)
+{
+  MultiArrayToImageData(input.data, input.layout, VTK_DOUBLE, result);
 }
 
 void vtkROS2ToSlicer(const std_msgs::msg::Int64MultiArray & input, vtkSmartPointer<vtkTable> result)
 {
-  // if input is not a 2D array raise an error
-  if (input.layout.dim.size() != 2){
-    std::cerr << "Input is not a 2D array" << std::endl;
-    return;
-  }
-  int numRows = input.layout.dim[0].size;
-  int numCols = input.layout.dim[1].size;
-  for(int i = 0; i < numCols; i++){
-    vtkSmartPointer<vtkIntArray> col = vtkSmartPointer<vtkIntArray>::New();
-    col->SetNumberOfValues(numRows);
-    for(int j = 0; j < numRows; j++){
-      col->SetValue(j, input.data[j*numCols + i]);
-    }
-    result->AddColumn(col);
-  }
+  MultiArrayToTable<vtkIntArray>(input.data, input.layout, result);
 }
 
 void vtkROS2ToSlicer(const std_msgs::msg::Float64MultiArray & input, vtkSmartPointer<vtkTable> result)
 {
-  // if input is not a 2D array raise an error
-  if (input.layout.dim.size() != 2){
-    std::cerr << "Input is not a 2D array" << std::endl;
-    return;
-  }
-  int numRows = input.layout.dim[0].size;
-  int numCols = input.layout.dim[1].size;
-  for(int i = 0; i < numCols; i++){
-    vtkSmartPointer<vtkDoubleArray> col = vtkSmartPointer<vtkDoubleArray>::New();
-    col->SetNumberOfValues(numRows);
-    for(int j = 0; j < numRows; j++){
-      col->SetValue(j, input.data[j*numCols + i]);
-    }
-    result->AddColumn(col);
-  }
+  MultiArrayToTable<vtkDoubleArray>(input.data, input.layout, result);
 }
 
 void vtkROS2ToSlicer(const sensor_msgs::msg::Joy & input, vtkSmartPointer<vtkTable> result)
 {
-  result->SetNumberOfRows(2); // Row 1 = button status, Row 2 = axes values
-  int numAxes = input.axes.size();
-  int numButtons = input.buttons.size();
-  for (int j = 0; j < numAxes; j++){
-    result->SetValue(1, j, vtkVariant(input.axes[j]));
+  // Row 1 = button status, Row 2 = axes values
+  const vtkIdType numAxes = input.axes.size();
+  const vtkIdType numButtons = input.buttons.size();
+  ResizeTable<vtkDoubleArray>(result, 2, std::max(numAxes, numButtons));
+  for (vtkIdType j = 0; j < result->GetNumberOfColumns(); j++){
+    double * column = vtkDoubleArray::FastDownCast(result->GetColumn(j))->GetPointer(0);
+    column[0] = (j < numButtons) ? input.buttons[j] : 0.0;
+    column[1] = (j < numAxes) ? input.axes[j] : 0.0;
+  }
+  result->Modified();
+}
+
+void vtkROS2ToSlicer(const sensor_msgs::msg::Image & input, vtkSmartPointer<vtkImageData> result)
+{
+  int scalarType;
+  int numberOfComponents = 1;
+  bool swapRedAndBlue = false;
+  const std::string & encoding = input.encoding;
+  if ((encoding == "mono8") || (encoding == "8UC1")) {
+    scalarType = VTK_UNSIGNED_CHAR;
+  } else if ((encoding == "mono16") || (encoding == "16UC1")) {
+    scalarType = VTK_UNSIGNED_SHORT;
+  } else if ((encoding == "rgb8") || (encoding == "bgr8")) {
+    scalarType = VTK_UNSIGNED_CHAR;
+    numberOfComponents = 3;
+    swapRedAndBlue = (encoding == "bgr8");
+  } else if (encoding == "32FC1") {
+    scalarType = VTK_FLOAT;
+  } else {
+    std::cerr << "Unsupported image encoding \"" << encoding << "\"" << std::endl;
+    return;
+  }
+  const size_t width = input.width;
+  const size_t height = input.height;
+  const int elementSize = vtkDataArray::GetDataTypeSize(scalarType);
+  const size_t rowSize = width * numberOfComponents * elementSize;
+  // step is the row length in bytes, including the padding
+  if ((input.step < rowSize) || (input.data.size() < input.step * height)) {
+    std::cerr << "Image data is smaller than its size" << std::endl;
+    return;
+  }
+  result->SetDimensions(width, height, 1);
+  if ((width == 0) || (height == 0)) {
+    result->Initialize();
+    return;
+  }
+  // reuses the existing scalars if the type matches
+  result->AllocateScalars(scalarType, numberOfComponents);
+  vtkDataArray * scalars = result->GetPointData()->GetScalars();
+  uint8_t * target = static_cast<uint8_t *>(scalars->GetVoidPointer(0));
+  const uint8_t * source = input.data.data();
+  // rows are kept in the message order, first row of the message is j = 0
+  if (swapRedAndBlue) {
+    for (size_t row = 0; row < height; ++row, source += input.step) {
+      for (size_t pixel = 0; pixel < 3 * width; pixel += 3, target += 3) {
+        target[0] = source[pixel + 2];
+        target[1] = source[pixel + 1];
+        target[2] = source[pixel];
+      }
+    }
+  } else if (input.step == rowSize) {
+    std::copy(source, source + rowSize * height, target);
+  } else {
+    for (size_t row = 0; row < height; ++row, source += input.step, target += rowSize) {
+      std::copy(source, source + rowSize, target);
+    }
   }
-  for (int j = 0; j < numButtons; j++){
-    result->SetValue(0, j, vtkVariant(input.buttons[j]));
+#ifdef VTK_WORDS_BIGENDIAN
+  const bool bigEndianHost = true;
+#else
+  const bool bigEndianHost = false;
+#endif
+  if ((elementSize > 1) && (static_cast<bool>(input.is_bigendian) != bigEndianHost)) {
+    vtkByteSwap::SwapVoidRange(scalars->GetVoidPointer(0), scalars->GetNumberOfValues(), elementSize);
   }
+  scalars->Modified();
+  result->Modified();
 }
 
 void vtkROS2ToSlicer(const geometry_msgs::msg::PoseStamped & input, vtkSmartPointer<vtkMatrix4x4> result)
@@ -164,3 +457,54 @@ void vtkROS2ToSlicer(const geometry_msgs::msg::TransformStamped & input, vtkSmar
   result->SetElement(1, 3, y);
   result->SetElement(2, 3, z);
 }
+
+bool vtkROS2ToSlicerValues(const std_msgs::msg::Bool & input, std::vector<double> & result)
+{
+  result.assign(1, input.data ? 1.0 : 0.0);
+  return true;
+}
+
+bool vtkROS2ToSlicerValues(const std_msgs::msg::Int64 & input, std::vector<double> & result)
+{
+  result.assign(1, static_cast<double>(input.data));
+  return true;
+}
+
+bool vtkROS2ToSlicerValues(const std_msgs::msg::Float64 & input, std::vector<double> & result)
+{
+  result.assign(1, input.data);
+  return true;
+}
+
+bool vtkROS2ToSlicerValues(const std_msgs::msg::Int64MultiArray & input, std::vector<double> & result)
+{
+  result.assign(input.data.begin(), input.data.end());
+  return true;
+}
+
+bool vtkROS2ToSlicerValues(const std_msgs::msg::Float64MultiArray & input, std::vector<double> & result)
+{
+  result.assign(input.data.begin(), input.data.end());
+  return true;
+}
+
+bool vtkROS2ToSlicerValues(const sensor_msgs::msg::Joy & input, std::vector<double> & result)
+{
+  // axes first, then buttons
+  result.assign(input.axes.begin(), input.axes.end());
+  result.insert(result.end(), input.buttons.begin(), input.buttons.end());
+  return true;
+}
+
+bool vtkROS2ToSlicerValues(const geometry_msgs::msg::PoseStamped & input, std::vector<double> & result)
+{
+  // position in mm (same as vtkMatrix4x4 conversion), then quaternion w, x, y, z
+  result = {input.pose.position.x * MM_TO_M_CONVERSION,
+            input.pose.position.y * MM_TO_M_CONVERSION,
+            input.pose.position.z * MM_TO_M_CONVERSION,
+            input.pose.orientation.w,
+            input.pose.orientation.x,
+            input.pose.orientation.y,
+            input.pose.orientation.z};
+  return true;
+}
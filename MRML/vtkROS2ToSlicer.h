@@ -7,7 +7,7 @@
 #include <vtkTable.h>
 #include <vtkIntArray.h>
 #include <vtkDoubleArray.h>
-#include <vtkTable.h>
+#include <vtkImageData.h>
 
 // ROS2
 #include <std_msgs/msg/string.hpp>
@@ -17,9 +17,12 @@
 #include <std_msgs/msg/int64_multi_array.hpp>
 #include <std_msgs/msg/float64_multi_array.hpp>
 #include <sensor_msgs/msg/joy.hpp>
+#include <sensor_msgs/msg/image.hpp>
 #include <geometry_msgs/msg/pose_stamped.hpp>
 #include "geometry_msgs/msg/transform_stamped.hpp"
 
+#include <vector>
+
 void vtkROS2ToSlicer(const std_msgs::msg::String & input, std::string & result);
 void vtkROS2ToSlicer(const std_msgs::msg::Bool & input, bool & result);
 void vtkROS2ToSlicer(const std_msgs::msg::Int64 & input, int & result);
@@ -27,10 +30,51 @@ void vtkROS2ToSlicer(const std_msgs::msg::Float64 & input, double & result);
 void vtkROS2ToSlicer(const std_msgs::msg::Int64MultiArray & input, vtkSmartPointer<vtkIntArray> result);
 void vtkROS2ToSlicer(const std_msgs::msg::Float64MultiArray & input, vtkSmartPointer<vtkDoubleArray> result);
 
+/*! N-dimensional arrays, up to 3 spatial dimensions (the last one is
+  x) plus the components.  The last dimension holds the components if
+  the array has 4 dimensions or if its label is "component(s)" or
+  "channel(s)".  Strides are honored and the scalars are updated in
+  place (vtkTypeInt64 or double). */
+void vtkROS2ToSlicer(const std_msgs::msg::Int64MultiArray & input, vtkSmartPointer<vtkImageData> result);
+void vtkROS2ToSlicer(const std_msgs::msg::Float64MultiArray & input, vtkSmartPointer<vtkImageData> result);
+
+/*! Zero-copy conversion, the result uses the memory of the ROS
+  message so the caller must keep the message alive as long as the
+  result uses it and the result must not be modified.  Returns false
+  if not supported for this pair of types or this message, in which
+  case the result is not modified. */
+template <typename _ros_type, typename _slicer_type>
+bool vtkROS2ToSlicerZeroCopy(const _ros_type &, _slicer_type *)
+{
+  return false;
+}
+bool vtkROS2ToSlicerZeroCopy(const std_msgs::msg::Float64MultiArray & input, vtkDoubleArray * result);
+
 void vtkROS2ToSlicer(const std_msgs::msg::Int64MultiArray & input, vtkSmartPointer<vtkTable> result);
 void vtkROS2ToSlicer(const std_msgs::msg::Float64MultiArray & input, vtkSmartPointer<vtkTable> result);
 void vtkROS2ToSlicer(const sensor_msgs::msg::Joy & input, vtkSmartPointer<vtkTable> result);
+/*! Supported encodings are mono8, mono16, rgb8, bgr8 (converted to
+  RGB) and 32FC1.  The padding at the end of each row (step) is
+  skipped and the scalars are updated in place. */
+void vtkROS2ToSlicer(const sensor_msgs::msg::Image & input, vtkSmartPointer<vtkImageData> result);
 void vtkROS2ToSlicer(const geometry_msgs::msg::PoseStamped & input, vtkSmartPointer<vtkMatrix4x4> result);
 void vtkROS2ToSlicer(const geometry_msgs::msg::TransformStamped & input, vtkSmartPointer<vtkMatrix4x4> result);
 
+/*! Flatten a ROS message to a vector of doubles, used to store the
+  subscribers' history in a vtkTable (one row per message).  Returns
+  false if the message can't be represented as numbers, this is the
+  default for message types without an overload. */
+template <typename _ros_type>
+bool vtkROS2ToSlicerValues(const _ros_type &, std::vector<double> &)
+{
+  return false;
+}
+bool vtkROS2ToSlicerValues(const std_msgs::msg::Bool & input, std::vector<double> & result);
+bool vtkROS2ToSlicerValues(const std_msgs::msg::Int64 & input, std::vector<double> & result);
+bool vtkROS2ToSlicerValues(const std_msgs::msg::Float64 & input, std::vector<double> & result);
+bool vtkROS2ToSlicerValues(const std_msgs::msg::Int64MultiArray & input, std::vector<double> & result);
+bool vtkROS2ToSlicerValues(const std_msgs::msg::Float64MultiArray & input, std::vector<double> & result);
+bool vtkROS2ToSlicerValues(const sensor_msgs::msg::Joy & input, std::vector<double> & result);
+bool vtkROS2ToSlicerValues(const geometry_msgs::msg::PoseStamped & input, std::vector<double> & result);
+
 #endif
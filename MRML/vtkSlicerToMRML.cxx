@@ -0,0 +1,187 @@
+#include <vtkSlicerToMRML.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <vtkAbstractArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+#include <vtkMRMLTableNode.h>
+#include <vtkMRMLTextNode.h>
+#include <vtkMRMLTransformNode.h>
+#include <vtkMRMLVolumeNode.h>
+
+namespace {
+
+  vtkMRMLTableNode * GetTableNode(vtkMRMLNode * node, std::string & errorMessage)
+  {
+    vtkMRMLTableNode * tableNode = vtkMRMLTableNode::SafeDownCast(node);
+    if (!tableNode || !tableNode->GetTable()) {
+      errorMessage = std::string("expected a vtkMRMLTableNode with a table, got ") + node->GetClassName();
+      return nullptr;
+    }
+    return tableNode;
+  }
+
+  /*! Write the values in one row of the table, the row and columns
+    are added if needed.  Existing columns keep their type.  A
+    negative row is replaced by the first row. */
+  bool SetTableRow(const std::vector<double> & values, vtkMRMLNode * node,
+                   const int & row, std::string & errorMessage)
+  {
+    vtkMRMLTableNode * tableNode = GetTableNode(node, errorMessage);
+    if (!tableNode) {
+      return false;
+    }
+    vtkTable * table = tableNode->GetTable();
+    const vtkIdType rowIndex = (row < 0) ? 0 : row;
+    const vtkIdType numberOfRows = std::max(table->GetNumberOfRows(), rowIndex + 1);
+    const vtkIdType numberOfValues = static_cast<vtkIdType>(values.size());
+    for (vtkIdType column = table->GetNumberOfColumns(); column < numberOfValues; ++column) {
+      vtkNew<vtkDoubleArray> newColumn;
+      newColumn->SetName(std::to_string(column).c_str());
+      newColumn->SetNumberOfTuples(table->GetNumberOfRows());
+      newColumn->Fill(0.0);
+      table->AddColumn(newColumn);
+    }
+    table->SetNumberOfRows(numberOfRows);
+    for (vtkIdType column = 0; column < numberOfValues; ++column) {
+      table->SetValue(rowIndex, column, vtkVariant(values[column]));
+    }
+    // the table node observes its table and invokes Modified
+    table->Modified();
+    return true;
+  }
+
+  bool SetTableRow(vtkDataArray * input, vtkMRMLNode * node,
+                   const int & row, std::string & errorMessage)
+  {
+    const vtkIdType numberOfValues = input->GetNumberOfValues();
+    std::vector<double> values(numberOfValues);
+    for (vtkIdType index = 0; index < numberOfValues; ++index) {
+      values[index] = input->GetVariantValue(index).ToDouble();
+    }
+    return SetTableRow(values, node, row, errorMessage);
+  }
+}
+
+
+bool vtkSlicerToMRML(const std::string & input, vtkMRMLNode * result, const int & vtkNotUsed(row), std::string & errorMessage)
+{
+  vtkMRMLTextNode * textNode = vtkMRMLTextNode::SafeDownCast(result);
+  if (!textNode) {
+    errorMessage = std::string("expected a vtkMRMLTextNode, got ") + result->GetClassName();
+    return false;
+  }
+  textNode->SetText(input.c_str());
+  return true;
+}
+
+
+bool vtkSlicerToMRML(const bool & input, vtkMRMLNode * result, const int & row, std::string & errorMessage)
+{
+  return SetTableRow(std::vector<double>(1, input ? 1.0 : 0.0), result, row, errorMessage);
+}
+
+
+bool vtkSlicerToMRML(const int & input, vtkMRMLNode * result, const int & row, std::string & errorMessage)
+{
+  return SetTableRow(std::vector<double>(1, input), result, row, errorMessage);
+}
+
+
+bool vtkSlicerToMRML(const double & input, vtkMRMLNode * result, const int & row, std::string & errorMessage)
+{
+  return SetTableRow(std::vector<double>(1, input), result, row, errorMessage);
+}
+
+
+bool vtkSlicerToMRML(vtkIntArray * input, vtkMRMLNode * result, const int & row, std::string & errorMessage)
+{
+  return SetTableRow(input, result, row, errorMessage);
+}
+
+
+bool vtkSlicerToMRML(vtkDoubleArray * input, vtkMRMLNode * result, const int & row, std::string & errorMessage)
+{
+  return SetTableRow(input, result, row, errorMessage);
+}
+
+
+bool vtkSlicerToMRML(vtkTable * input, vtkMRMLNode * result, const int & row, std::string & errorMessage)
+{
+  if (row >= 0) {
+    // one row, values in row major order, all components of
+    // multi-component columns (e.g. arrays in generic messages)
+    std::vector<double> values;
+    values.reserve(input->GetNumberOfRows() * input->GetNumberOfColumns());
+    for (vtkIdType inputRow = 0; inputRow < input->GetNumberOfRows(); ++inputRow) {
+      for (vtkIdType column = 0; column < input->GetNumberOfColumns(); ++column) {
+        vtkAbstractArray * columnArray = input->GetColumn(column);
+        const vtkIdType numberOfComponents = columnArray->GetNumberOfComponents();
+        for (vtkIdType component = 0; component < numberOfComponents; ++component) {
+          values.push_back(columnArray->GetVariantValue(inputRow * numberOfComponents + component).ToDouble());
+        }
+      }
+    }
+    return SetTableRow(values, result, row, errorMessage);
+  }
+  vtkMRMLTableNode * tableNode = GetTableNode(result, errorMessage);
+  if (!tableNode) {
+    return false;
+  }
+  // deep copy since the subscriber updates its table in place
+  tableNode->GetTable()->DeepCopy(input);
+  tableNode->GetTable()->Modified();
+  return true;
+}
+
+
+bool vtkSlicerToMRML(vtkMatrix4x4 * input, vtkMRMLNode * result, const int & vtkNotUsed(row), std::string & errorMessage)
+{
+  vtkMRMLTransformNode * transformNode = vtkMRMLTransformNode::SafeDownCast(result);
+  if (!transformNode) {
+    errorMessage = std::string("expected a vtkMRMLTransformNode, got ") + result->GetClassName();
+    return false;
+  }
+  transformNode->SetMatrixTransformToParent(input);
+  return true;
+}
+
+
+bool vtkSlicerToMRML(vtkImageData * input, vtkMRMLNode * result, const int & vtkNotUsed(row), std::string & errorMessage)
+{
+  vtkMRMLVolumeNode * volumeNode = vtkMRMLVolumeNode::SafeDownCast(result);
+  if (!volumeNode) {
+    errorMessage = std::string("expected a vtkMRMLVolumeNode, got ") + result->GetClassName();
+    return false;
+  }
+  if (!volumeNode->GetImageData()) {
+    vtkNew<vtkImageData> imageData;
+    volumeNode->SetAndObserveImageData(imageData);
+  }
+  vtkImageData * imageData = volumeNode->GetImageData();
+  vtkDataArray * source = input->GetPointData()->GetScalars();
+  vtkDataArray * target = imageData->GetPointData()->GetScalars();
+  int inputDimensions[3], dimensions[3];
+  input->GetDimensions(inputDimensions);
+  imageData->GetDimensions(dimensions);
+  if (source && target
+      && std::equal(inputDimensions, inputDimensions + 3, dimensions)
+      && (source->GetDataType() == target->GetDataType())
+      && (source->GetNumberOfComponents() == target->GetNumberOfComponents())
+      && (source->GetNumberOfTuples() == target->GetNumberOfTuples())) {
+    // same geometry, one bulk copy in the existing scalars so the
+    // display pipeline doesn't have to reallocate anything
+    const uint8_t * begin = static_cast<const uint8_t *>(source->GetVoidPointer(0));
+    std::copy(begin, begin + source->GetNumberOfValues() * source->GetDataTypeSize(),
+              static_cast<uint8_t *>(target->GetVoidPointer(0)));
+    target->Modified();
+  } else {
+    // deep copy since the subscriber updates its image in place
+    imageData->DeepCopy(input);
+  }
+  imageData->Modified();
+  return true;
+}
@@ -0,0 +1,44 @@
+#ifndef __vtkSlicerToMRML_h
+#define __vtkSlicerToMRML_h
+
+#include <string>
+
+// VTK
+#include <vtkDoubleArray.h>
+#include <vtkImageData.h>
+#include <vtkIntArray.h>
+#include <vtkMatrix4x4.h>
+#include <vtkTable.h>
+
+// MRML
+#include <vtkMRMLNode.h>
+
+/*! Conversions from the Slicer types used by subscribers to MRML
+  nodes, used to drive a MRML node from a topic (see
+  vtkMRMLROS2SubscriberNode::DriveNode).  Supported nodes are
+  transform nodes for matrices, text nodes for strings, volume nodes
+  for images and table nodes for numbers, arrays and tables.  If row
+  is negative, a table replaces the content of the table node,
+  otherwise the values are written in the given row (added if
+  needed).  Return false and set the error message if the MRML node
+  is not of the expected class. */
+bool vtkSlicerToMRML(const std::string & input, vtkMRMLNode * result, const int & row, std::string & errorMessage);
+bool vtkSlicerToMRML(const bool & input, vtkMRMLNode * result, const int & row, std::string & errorMessage);
+bool vtkSlicerToMRML(const int & input, vtkMRMLNode * result, const int & row, std::string & errorMessage);
+bool vtkSlicerToMRML(const double & input, vtkMRMLNode * result, const int & row, std::string & errorMessage);
+bool vtkSlicerToMRML(vtkIntArray * input, vtkMRMLNode * result, const int & row, std::string & errorMessage);
+bool vtkSlicerToMRML(vtkDoubleArray * input, vtkMRMLNode * result, const int & row, std::string & errorMessage);
+bool vtkSlicerToMRML(vtkTable * input, vtkMRMLNode * result, const int & row, std::string & errorMessage);
+bool vtkSlicerToMRML(vtkMatrix4x4 * input, vtkMRMLNode * result, const int & row, std::string & errorMessage);
+bool vtkSlicerToMRML(vtkImageData * input, vtkMRMLNode * result, const int & row, std::string & errorMessage);
+
+// for all other types
+template <typename _slicer_type>
+bool vtkSlicerToMRML(const _slicer_type & vtkNotUsed(input), vtkMRMLNode * result,
+                     const int & vtkNotUsed(row), std::string & errorMessage)
+{
+  errorMessage = std::string("driving a ") + result->GetClassName() + " is not supported for this subscriber type";
+  return false;
+}
+
+#endif // __vtkSlicerToMRML_h
@@ -1,8 +1,111 @@
 #include <vtkSlicerToROS2.h>
+#include <algorithm>
 #include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkEndian.h> // VTK_WORDS_BIGENDIAN
 
 const double M_TO_MM = 0.001;
 
+namespace {
+
+  /*! Fill the row major data from the table, using the column arrays
+    directly when they have the expected type. */
+  template <typename _array_type, typename _value_type>
+  void TableToMultiArray(vtkTable * input, std::vector<_value_type> & data)
+  {
+    const vtkIdType numCols = input->GetNumberOfColumns();
+    const vtkIdType numRows = input->GetNumberOfRows();
+    for (vtkIdType j = 0; j < numCols; j++){
+      _array_type * column = _array_type::FastDownCast(input->GetColumn(j));
+      if (column && (column->GetNumberOfComponents() == 1)
+          && (column->GetNumberOfTuples() >= numRows)) {
+        const auto * values = column->GetPointer(0);
+        for (vtkIdType i = 0; i < numRows; i++){
+          data[i*numCols + j] = values[i];
+        }
+      } else {
+        for (vtkIdType i = 0; i < numRows; i++){
+          data[i*numCols + j] = input->GetValue(i, j).ToDouble();
+        }
+      }
+    }
+  }
+
+  /*! Arrays with one component are sent as 1D arrays, arrays with
+    more components as 2D arrays with one row per tuple. */
+  template <typename _array_type, typename _message_type>
+  void DataArrayToMultiArray(_array_type * input, _message_type & result)
+  {
+    const vtkIdType numElements = input->GetNumberOfValues();
+    const int numComponents = input->GetNumberOfComponents();
+    if (numComponents == 1) {
+      result.layout.dim.resize(1);
+      result.layout.dim[0].label = "x";
+      result.layout.dim[0].size = numElements;
+      result.layout.dim[0].stride = 1;
+    } else {
+      result.layout.dim.resize(2);
+      result.layout.dim[0].label = "x";
+      result.layout.dim[0].size = input->GetNumberOfTuples();
+      result.layout.dim[0].stride = numElements;
+      result.layout.dim[1].label = "component";
+      result.layout.dim[1].size = numComponents;
+      result.layout.dim[1].stride = numComponents;
+    }
+    result.layout.data_offset = 0;
+    result.data.resize(numElements);
+    if (numElements > 0) {
+      std::copy(input->GetPointer(0), input->GetPointer(0) + numElements, result.data.begin());
+    }
+  }
+
+  /*! Dimensions are z, y, x and component if the image has more than
+    one component.  The scalars are converted with a bulk copy
+    whatever their type. */
+  template <typename _message_type>
+  void ImageDataToMultiArray(vtkImageData * input, _message_type & result)
+  {
+    vtkDataArray * scalars = input->GetPointData()->GetScalars();
+    int dimensions[3] = {0, 0, 0};
+    int numComponents = 1;
+    if (scalars) {
+      input->GetDimensions(dimensions);
+      numComponents = scalars->GetNumberOfComponents();
+    }
+    result.layout.dim.resize((numComponents > 1) ? 4 : 3);
+    const char * labels[3] = {"z", "y", "x"};
+    for (size_t k = 0; k < 3; ++k) {
+      result.layout.dim[k].label = labels[k];
+      result.layout.dim[k].size = dimensions[2 - k];
+    }
+    if (numComponents > 1) {
+      result.layout.dim[3].label = "component";
+      result.layout.dim[3].size = numComponents;
+    }
+    // dense strides, product of the sizes of the dimension and the inner ones
+    size_t stride = 1;
+    for (size_t k = result.layout.dim.size(); k-- > 0; ) {
+      stride *= result.layout.dim[k].size;
+      result.layout.dim[k].stride = stride;
+    }
+    result.layout.data_offset = 0;
+    const vtkIdType numElements = scalars ? scalars->GetNumberOfValues() : 0;
+    result.data.resize(numElements);
+    if (numElements == 0) {
+      return;
+    }
+    switch (scalars->GetDataType()) {
+      vtkTemplateMacro(std::copy(static_cast<VTK_TT *>(scalars->GetVoidPointer(0)),
+                                 static_cast<VTK_TT *>(scalars->GetVoidPointer(0)) + numElements,
+                                 result.data.begin()));
+    default:
+      std::cerr << "Unsupported scalar type " << scalars->GetDataTypeAsString() << std::endl;
+      result.data.clear();
+    }
+  }
+}
+
 void vtkSlicerToROS2(const std::string & input,  std_msgs::msg::String & result,
 		     const std::shared_ptr<rclcpp::Node> &)
 {
@@ -30,31 +133,13 @@ void vtkSlicerToROS2(const double & input,  std_msgs::msg::Float64 & result,
 void vtkSlicerToROS2(vtkIntArray * input,  std_msgs::msg::Int64MultiArray & result,
 		     const std::shared_ptr<rclcpp::Node> &)
 {
-  int numElements = input->GetNumberOfValues();
-  result.layout.dim.resize(1);
-  result.layout.dim[0].label = "x";
-  result.layout.dim[0].size = numElements;
-  result.layout.dim[0].stride = 1;
-  result.data.resize(numElements);
-  for (int j = 0; j < numElements; j++){
-    result.data[j] = input->GetValue(j);
-  }
+  DataArrayToMultiArray(input, result);
 }
 
 void vtkSlicerToROS2(vtkDoubleArray * input,  std_msgs::msg::Float64MultiArray & result,
 		     const std::shared_ptr<rclcpp::Node> &)
 {
-  int numElements = input->GetNumberOfValues();
-  // set result dim to be 1
-  result.layout.dim.resize(1);
-  result.layout.dim[0].label = "x";
-  result.layout.dim[0].size = numElements;
-  result.layout.dim[0].stride = 1;
-
-  result.data.resize(numElements);
-  for (int j = 0; j < numElements; j++){
-    result.data[j] = input->GetValue(j);
-  }
+  DataArrayToMultiArray(input, result);
 }
 
 void vtkSlicerToROS2(vtkTable * input,  std_msgs::msg::Int64MultiArray & result,
@@ -66,18 +151,14 @@ void vtkSlicerToROS2(vtkTable * input,  std_msgs::msg::Int64MultiArray & result,
   result.layout.dim.resize(2);
   result.layout.dim[0].label = "x";
   result.layout.dim[0].size = numRows;
-  result.layout.dim[0].stride = numCols;
+  result.layout.dim[0].stride = numRows * numCols;
   result.layout.dim[1].label = "y";
   result.layout.dim[1].size = numCols;
-  result.layout.dim[1].stride = 1;
+  result.layout.dim[1].stride = numCols;
 
   result.data.resize(numRows*numCols);
 
-  for (int i = 0; i < numRows; i++){
-    for (int j = 0; j < numCols; j++){
-      result.data[i*numCols + j] = input->GetValue(i, j).ToInt();
-    }
-  }
+  TableToMultiArray<vtkIntArray>(input, result.data);
 }
 
 void vtkSlicerToROS2(vtkTable * input,  std_msgs::msg::Float64MultiArray & result,
@@ -89,18 +170,26 @@ void vtkSlicerToROS2(vtkTable * input,  std_msgs::msg::Float64MultiArray & resul
   result.layout.dim.resize(2);
   result.layout.dim[0].label = "x";
   result.layout.dim[0].size = numRows;
-  result.layout.dim[0].stride = numCols;
+  result.layout.dim[0].stride = numRows * numCols;
   result.layout.dim[1].label = "y";
   result.layout.dim[1].size = numCols;
-  result.layout.dim[1].stride = 1;
+  result.layout.dim[1].stride = numCols;
 
   result.data.resize(numRows*numCols);
 
-  for (int i = 0; i < numRows; i++){
-    for (int j = 0; j < numCols; j++){
-      result.data[i*numCols + j] = input->GetValue(i, j).ToDouble();
-    }
-  }
+  TableToMultiArray<vtkDoubleArray>(input, result.data);
+}
+
+void vtkSlicerToROS2(vtkImageData * input,  std_msgs::msg::Int64MultiArray & result,
+		     const std::shared_ptr<rclcpp::Node> &)
+{
+  ImageDataToMultiArray(input, result);
+}
+
+void vtkSlicerToROS2(vtkImageData * input,  std_msgs::msg::Float64MultiArray & result,
+		     const std::shared_ptr<rclcpp::Node> &)
+{
+  ImageDataToMultiArray(input, result);
 }
 
 // Work in Progress
@@ -165,13 +254,15 @@ void vtkSlicerToROS2(vtkTransformCollection * input, geometry_msgs::msg::PoseArr
 {
   result.header.frame_id = "slicer"; // VTK 9.2 will support input->GetObjectName();
   result.header.stamp = rosNode->get_clock()->now();
-  result.poses.clear();
+  // the result might be reused, fill the existing poses in place
+  result.poses.resize(input->GetNumberOfItems());
+  size_t numberOfPoses = 0;
 
   for (int i = 0; i < input->GetNumberOfItems(); i++){
     vtkTransform* transform = vtkTransform::SafeDownCast(input->GetItemAsObject(i));
     if (transform){
       vtkMatrix4x4* matrix = transform->GetMatrix();
-      geometry_msgs::msg::Pose pose;
+      geometry_msgs::msg::Pose & pose = result.poses[numberOfPoses];
 
       double q[4] = {0.0, 0.0, 0.0, 0.0};
       vtkMatrix4x4ToQuaternion(matrix, q);
@@ -182,25 +273,71 @@ void vtkSlicerToROS2(vtkTransformCollection * input, geometry_msgs::msg::PoseArr
       pose.orientation.x = q[1];
       pose.orientation.y = q[2];
       pose.orientation.z = q[3];
-
-      result.poses.push_back(pose);
+      numberOfPoses++;
     }
   }
+  result.poses.resize(numberOfPoses);
 }
 
 void vtkSlicerToROS2(vtkTypeUInt8Array * input, sensor_msgs::msg::Image & result,
          const std::shared_ptr<rclcpp::Node> & rosNode)
 {
   result.header.stamp = rosNode->get_clock()->now();
-  std::vector<uint8_t> picture; 
   result.width = input->GetNumberOfComponents();
   result.height = input->GetNumberOfTuples();
   result.encoding = "mono8"; // grayscale for ultrasound
-  int numberOfValues = input->GetNumberOfValues();
-  for (int i = 0; i < numberOfValues; i ++){
-    picture.push_back(input->GetValue(i));
-  } 
-  result.data = picture;
+  result.step = result.width;
+  // the result might be reused, only reallocate if the size changed
+  const vtkIdType numberOfValues = input->GetNumberOfValues();
+  result.data.resize(numberOfValues);
+  if (numberOfValues > 0) {
+    std::copy(input->GetPointer(0), input->GetPointer(0) + numberOfValues, result.data.begin());
+  }
+}
+
+void vtkSlicerToROS2(vtkImageData * input, sensor_msgs::msg::Image & result,
+         const std::shared_ptr<rclcpp::Node> & rosNode)
+{
+  result.header.stamp = rosNode->get_clock()->now();
+  vtkDataArray * scalars = input->GetPointData()->GetScalars();
+  int dimensions[3] = {0, 0, 0};
+  if (scalars) {
+    input->GetDimensions(dimensions);
+  }
+  const int numberOfComponents = scalars ? scalars->GetNumberOfComponents() : 1;
+  const int scalarType = scalars ? scalars->GetDataType() : VTK_UNSIGNED_CHAR;
+  if ((scalarType == VTK_UNSIGNED_CHAR) && (numberOfComponents == 1)) {
+    result.encoding = "mono8";
+  } else if ((scalarType == VTK_UNSIGNED_CHAR) && (numberOfComponents == 3)) {
+    result.encoding = "rgb8";
+  } else if ((scalarType == VTK_UNSIGNED_SHORT) && (numberOfComponents == 1)) {
+    result.encoding = "mono16";
+  } else if ((scalarType == VTK_FLOAT) && (numberOfComponents == 1)) {
+    result.encoding = "32FC1";
+  } else {
+    std::cerr << "Unsupported image, " << numberOfComponents << " component(s) of type "
+              << vtkImageScalarTypeNameMacro(scalarType) << std::endl;
+    // the message might be reused, don't keep the previous encoding
+    result.encoding.clear();
+    dimensions[0] = dimensions[1] = 0;
+  }
+#ifdef VTK_WORDS_BIGENDIAN
+  result.is_bigendian = 1;
+#else
+  result.is_bigendian = 0;
+#endif
+  // ROS images are 2D, only the first slice of a 3D image is sent
+  result.width = dimensions[0];
+  result.height = dimensions[1];
+  result.step = result.width * numberOfComponents * vtkDataArray::GetDataTypeSize(scalarType);
+  // the result might be reused, only reallocate if the size changed
+  const size_t numberOfBytes = static_cast<size_t>(result.step) * result.height;
+  result.data.resize(numberOfBytes);
+  if (numberOfBytes > 0) {
+    // rows of the image data are contiguous, the slice is copied at once
+    const uint8_t * source = static_cast<const uint8_t *>(scalars->GetVoidPointer(0));
+    std::copy(source, source + numberOfBytes, result.data.begin());
+  }
 }
 
 void vtkMatrix4x4ToQuaternion(vtkMatrix4x4 * input, double quaternion[4])
@@ -213,3 +350,19 @@ void vtkMatrix4x4ToQuaternion(vtkMatrix4x4 * input, double quaternion[4])
   }
   vtkMath::Matrix3x3ToQuaternion(A, quaternion);
 }
+
+void vtkMRMLROS2Snapshot(vtkTransformCollection * input, vtkSmartPointer<vtkTransformCollection> & result)
+{
+  if (!result) {
+    result = vtkSmartPointer<vtkTransformCollection>::New();
+  }
+  result->RemoveAllItems();
+  for (int i = 0; i < input->GetNumberOfItems(); i++){
+    vtkTransform* transform = vtkTransform::SafeDownCast(input->GetItemAsObject(i));
+    if (transform){
+      vtkNew<vtkTransform> copy;
+      copy->DeepCopy(transform);
+      result->AddItem(copy);
+    }
+  }
+}
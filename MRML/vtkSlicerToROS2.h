@@ -8,6 +8,7 @@
 #include <vtkSmartPointer.h>
 #include <vtkDoubleArray.h>
 #include <vtkIntArray.h>
+#include <vtkImageData.h>
 #include <vtkTransformCollection.h>
 #include <vtkTable.h>
 #include <vtkTypeUInt8Array.h>
@@ -42,6 +43,10 @@ void vtkSlicerToROS2(vtkTable * input,  std_msgs::msg::Int64MultiArray & result,
 		     const std::shared_ptr<rclcpp::Node> & rosNode);
 void vtkSlicerToROS2(vtkTable * input,  std_msgs::msg::Float64MultiArray & result,
 		     const std::shared_ptr<rclcpp::Node> & rosNode);
+void vtkSlicerToROS2(vtkImageData * input,  std_msgs::msg::Int64MultiArray & result,
+		     const std::shared_ptr<rclcpp::Node> & rosNode);
+void vtkSlicerToROS2(vtkImageData * input,  std_msgs::msg::Float64MultiArray & result,
+		     const std::shared_ptr<rclcpp::Node> & rosNode);
 void vtkSlicerToROS2(vtkMatrix4x4 * input,  geometry_msgs::msg::PoseStamped & result,
 		     const std::shared_ptr<rclcpp::Node> & rosNode);
 void vtkSlicerToROS2(vtkMatrix4x4 * input, geometry_msgs::msg::TransformStamped & result,
@@ -50,10 +55,31 @@ void vtkSlicerToROS2(vtkDoubleArray * input, geometry_msgs::msg::WrenchStamped &
 		     const std::shared_ptr<rclcpp::Node> & rosNode);
 void vtkSlicerToROS2(vtkTransformCollection * input, geometry_msgs::msg::PoseArray & result,
 		     const std::shared_ptr<rclcpp::Node> & rosNode);
+/*! Images are sent as mono8, rgb8, mono16 or 32FC1 depending on
+  their scalar type and number of components.  Only the first slice
+  of a 3D image is sent.  For other images, the encoding is cleared
+  and the message is not published (see vtkSlicerToROS2IsValid). */
+void vtkSlicerToROS2(vtkImageData * input, sensor_msgs::msg::Image & result,
+         const std::shared_ptr<rclcpp::Node> & rosNode);
 void vtkSlicerToROS2(vtkTypeUInt8Array * input, sensor_msgs::msg::Image & result,
 		     const std::shared_ptr<rclcpp::Node> & rosNode);
 
+/*! Publishers only send messages for which the conversion succeeded.
+  Most conversions can't fail. */
+template <typename _ros_type>
+inline bool vtkSlicerToROS2IsValid(const _ros_type &)
+{
+  return true;
+}
+inline bool vtkSlicerToROS2IsValid(const sensor_msgs::msg::Image & message)
+{
+  return !message.encoding.empty();
+}
+
 // helper function
 void vtkMatrix4x4ToQuaternion(vtkMatrix4x4 * input, double quaternion[4]);
 
+// copy for asynchronous publishers, collections don't support DeepCopy
+void vtkMRMLROS2Snapshot(vtkTransformCollection * input, vtkSmartPointer<vtkTransformCollection> & result);
+
 #endif // __vtkSlicerToROS2_h
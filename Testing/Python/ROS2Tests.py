@@ -1,5 +1,7 @@
 import logging
 import os
+import json
+import tempfile
 
 import vtk
 
@@ -8,6 +10,7 @@ from slicer.ScriptedLoadableModule import *
 from slicer.util import VTKObservationMixin
 import unittest
 import subprocess
+import time
 import logging
 import sys
 try:
@@ -118,6 +121,20 @@ class ROS2TestsLogic(ScriptedLoadableModuleLogic):
         for i in range(3):
             ros2Logic.Spin()
 
+    @classmethod
+    def spin_until(self, condition, timeout = 5.0):
+        # spin until the condition is met, messages received or sent
+        # by other threads might take a while on a loaded machine
+        ros2Logic = slicer.util.getModuleLogic('ROS2')
+        end = time.time() + timeout
+        while True:
+            ros2Logic.Spin()
+            if condition():
+                return True
+            if time.time() > end:
+                return False
+            time.sleep(0.01)
+
     @classmethod
     def run_ros2_cli_command_blocking(self, command):
         ros2_process = subprocess.Popen(
@@ -199,6 +216,16 @@ class ROS2TestsLogic(ScriptedLoadableModuleLogic):
                             "Message not received correctly by observer")
             self.assertTrue(self.testObs.counter == 1,
                             "Observer number of calls incorrect")
+            self.assertTrue(self.testSub.GetCallbackStatistics().GetNumberOfSamples() >= 1,
+                            "Callback statistics not updated")
+            # conversion to Slicer type is cached, at most one conversion per message
+            numberOfConversions = self.testSub.GetConversionStatistics().GetNumberOfSamples()
+            self.testSub.GetLastMessageVariant()
+            self.testSub.GetLastMessageVariant()
+            self.assertTrue(self.testSub.GetConversionStatistics().GetNumberOfSamples() - numberOfConversions <= 1,
+                            "Conversion not cached")
+            self.assertTrue(self.testSub.GetLastMessageVersion() == finalSubMessageCount,
+                            "Last message version incorrect")
 
         def delete_pub_sub(self):
             self.testSub.RemoveObserver(self.observerId)
@@ -222,6 +249,23 @@ class ROS2TestsLogic(ScriptedLoadableModuleLogic):
             self.delete_pub_sub()
             print("Testing creation and working of publisher and subscriber - Done")
 
+        def test_node_spin_with_logic(self):
+            print("\nTesting node spin on a node owned by the logic - Starting..")
+            self.create_pub_sub("String")
+
+            initSubMessageCount = self.testSub.GetNumberOfMessages()
+            self.testPub.Publish("spin")
+            # the logic's executor owns the ROS node, the node's Spin
+            # must not try to add it to another executor
+            for i in range(3):
+                self.ros2Node.Spin()
+            self.assertTrue(ROS2TestsLogic.spin_until(lambda: self.testSub.GetNumberOfMessages() > initSubMessageCount),
+                            "Message not received")
+            self.assertTrue(self.testSub.GetLastMessage() == "spin", "Message not received correctly")
+
+            self.delete_pub_sub()
+            print("Testing node spin on a node owned by the logic - Done")
+
         def test_create_and_add_pub_sub_matrix(self):
             print("\nTesting creation and working of publisher and subscriber - Starting..")
             self.create_pub_sub("PoseStamped")
@@ -300,9 +344,58 @@ class ROS2TestsLogic(ScriptedLoadableModuleLogic):
             for i in range(sentDoubleVtkArray.GetNumberOfValues()):
                 self.assertTrue(sentDoubleVtkArray.GetValue(i) == receivedDoubleArray.GetValue(i), "Message not received correctly")
 
+            # the publisher reuses its ROS message, check a shorter array is not padded
+            sentDoubleVtkArray.SetNumberOfValues(2)
+            self.testPub.Publish(sentDoubleVtkArray)
+            ROS2TestsLogic.spin_some()
+            receivedDoubleArray = self.testSub.GetLastMessage()
+            self.assertTrue(receivedDoubleArray.GetNumberOfValues() == 2, "Reused message not resized")
+            self.assertTrue(receivedDoubleArray.GetValue(1) == sentDoubleArray[1], "Reused message not received correctly")
+
             self.delete_pub_sub()
             print("Testing creation and working of publisher and subscriber - Done")
 
+        def test_zero_copy_double_array(self):
+            print("\nTesting zero-copy subscriber - Starting..")
+            self.create_pub_sub("DoubleArray")
+            self.testSub.SetZeroCopy(True)
+
+            for size in [1000, 10]:
+                initSubMessageCount = self.testSub.GetNumberOfMessages()
+                sentArray = vtk.vtkDoubleArray()
+                sentArray.SetNumberOfValues(size)
+                for i in range(size):
+                    sentArray.SetValue(i, 0.5 * i + size)
+                self.testPub.Publish(sentArray)
+                ROS2TestsLogic.spin_some()
+                self.assertTrue(self.testSub.GetNumberOfMessages() - initSubMessageCount == 1, "Message not received")
+                receivedArray = self.testSub.GetLastMessage()
+                self.assertTrue(receivedArray.GetNumberOfValues() == size, "Message not received correctly")
+                for i in range(size):
+                    self.assertTrue(receivedArray.GetValue(i) == sentArray.GetValue(i), "Message not received correctly")
+
+            self.delete_pub_sub()
+
+            # with intra-process comms the message is shared, zero-copy is ignored
+            intraProcessNode = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLROS2NodeNode")
+            intraProcessNode.Create("testNodeZeroCopyIntraProcess", False, True)
+            topic = "slicer_test_zero_copy_intra_process"
+            testPub = intraProcessNode.CreateAndAddPublisherNode("vtkMRMLROS2PublisherDoubleArrayNode", topic)
+            testSub = intraProcessNode.CreateAndAddSubscriberNode("vtkMRMLROS2SubscriberDoubleArrayNode", topic)
+            testSub.SetZeroCopy(True)
+            sentArray = vtk.vtkDoubleArray()
+            for value in [1.5, 2.5, 3.5]:
+                sentArray.InsertNextValue(value)
+            self.assertTrue(ROS2TestsLogic.spin_until(lambda: testPub.Publish(sentArray) >= 1), "Subscriber not matched")
+            self.assertTrue(ROS2TestsLogic.spin_until(lambda: testSub.GetNumberOfMessages() >= 1), "Message not received")
+            receivedArray = testSub.GetLastMessage()
+            self.assertTrue(receivedArray.GetValue(2) == 3.5, "Message not received correctly")
+            receivedArray.SetValue(2, 42.0)
+            self.assertFalse("42" in testSub.GetLastMessageYAML(), "Shared intra-process message modified")
+            intraProcessNode.Destroy()
+            ROS2TestsLogic.spin_some()
+            print("Testing zero-copy subscriber - Done")
+
         def test_create_and_add_pub_sub_int_n_array(self):
             print("\nTesting creation and working of publisher and subscriber for N-array - Starting..")
             self.create_pub_sub("IntTable")
@@ -362,6 +455,670 @@ class ROS2TestsLogic(ScriptedLoadableModuleLogic):
             self.delete_pub_sub()
             print("Testing creation and working of publisher and subscriber - Done")
 
+        def test_column_major_table(self):
+            print("\nTesting column major table subscriber - Starting..")
+            self.topic = "slicer_test_column_major_table"
+            self.testPub = self.ros2Node.CreateAndAddGenericPublisherNode("std_msgs/msg/Float64MultiArray", self.topic)
+            self.testSub = self.ros2Node.CreateAndAddSubscriberNode("vtkMRMLROS2SubscriberDoubleTableNode", self.topic)
+            self.observerId = self.testSub.AddObserver("ModifiedEvent", self.testObs.Callback)
+            ROS2TestsLogic.spin_some()
+
+            # 3 rows, 2 columns, values of each column are contiguous
+            self.assertTrue(self.testPub.SetField("layout.dim[0].label", "column"))
+            self.assertTrue(self.testPub.SetField("layout.dim[0].size", 2))
+            self.assertTrue(self.testPub.SetField("layout.dim[1].label", "row"))
+            self.assertTrue(self.testPub.SetField("layout.dim[1].size", 3))
+            for message in range(2):
+                for i in range(6):
+                    self.assertTrue(self.testPub.SetField("data[%d]" % i, 10.0 * message + i))
+                initSubMessageCount = self.testSub.GetNumberOfMessages()
+                self.testPub.Publish()
+                self.generic_assertions(initSubMessageCount)
+                receivedVtkTable = self.testSub.GetLastMessage()
+                self.assertTrue(receivedVtkTable.GetNumberOfColumns() == 2, "Table not updated in place")
+                self.assertTrue(receivedVtkTable.GetNumberOfRows() == 3, "Table not updated in place")
+                for i in range(2):
+                    for j in range(3):
+                        self.assertTrue(receivedVtkTable.GetValue(j, i).ToDouble() == 10.0 * message + i * 3 + j, "Message not received correctly")
+
+            self.delete_pub_sub()
+            print("Testing column major table subscriber - Done")
+
+        def test_tensor_pub_sub(self):
+            print("\nTesting tensor publisher and subscriber - Starting..")
+            self.create_pub_sub("DoubleTensor")
+            initSubMessageCount = self.testSub.GetNumberOfMessages()
+
+            image = vtk.vtkImageData()
+            image.SetDimensions(4, 3, 2)
+            image.AllocateScalars(vtk.VTK_FLOAT, 2)
+            scalars = image.GetPointData().GetScalars()
+            for i in range(scalars.GetNumberOfValues()):
+                scalars.SetValue(i, 0.5 * i)
+            self.testPub.Publish(image)
+            self.generic_assertions(initSubMessageCount)
+
+            receivedImage = self.testSub.GetLastMessage()
+            self.assertTrue(receivedImage.GetDimensions() == (4, 3, 2), "Image dimensions incorrect")
+            receivedScalars = receivedImage.GetPointData().GetScalars()
+            self.assertTrue(receivedScalars.GetNumberOfComponents() == 2, "Image components incorrect")
+            for i in range(scalars.GetNumberOfValues()):
+                self.assertTrue(receivedScalars.GetValue(i) == 0.5 * i, "Message not received correctly")
+
+            self.delete_pub_sub()
+            print("Testing tensor publisher and subscriber - Done")
+
+        def test_background_pub_sub(self):
+            print("\nTesting publisher and subscriber on a node spinning in background - Starting..")
+            backgroundNode = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLROS2NodeNode")
+            backgroundNode.Create("testBackgroundNode", True)
+            self.assertTrue(backgroundNode.GetSpinInBackground())
+            topic = "slicer_test_background"
+            testPub = backgroundNode.CreateAndAddPublisherNode("vtkMRMLROS2PublisherIntNode", topic)
+            testSub = backgroundNode.CreateAndAddSubscriberNode("vtkMRMLROS2SubscriberIntNode", topic)
+            # wait for the subscriber to be matched and the first message to be moved to MRML
+            self.assertTrue(ROS2TestsLogic.spin_until(lambda: testPub.Publish(-1) >= 1), "Subscriber not matched")
+            self.assertTrue(ROS2TestsLogic.spin_until(lambda: testSub.GetLastMessage() == -1), "Message not received")
+            ROS2TestsLogic.spin_some()
+
+            # several messages between two spins, the slot only keeps the
+            # latest one but all messages are counted
+            initSubMessageCount = testSub.GetNumberOfMessages()
+            for value in range(5):
+                testPub.Publish(value)
+            self.assertTrue(ROS2TestsLogic.spin_until(lambda: testSub.GetNumberOfMessages() - initSubMessageCount >= 5),
+                            "Messages not received")
+            ROS2TestsLogic.spin_some()
+            self.assertTrue(testSub.GetNumberOfMessages() - initSubMessageCount == 5, "Messages not counted correctly")
+            self.assertTrue(testSub.GetLastMessage() == 4, "Last message incorrect")
+            self.assertTrue(testSub.GetLastMessageVersion() == testSub.GetNumberOfMessages(), "Last message version incorrect")
+            # the parameter services are executed in background too, the
+            # node only needs to be spun when woken up
+            self.assertFalse(backgroundNode.RequiresPolling(), "Background node requires polling")
+            self.assertFalse(self.ros2Node.RequiresPolling(), "Node without foreground callbacks requires polling")
+            ros2Logic = slicer.util.getModuleLogic('ROS2')
+            pollingNodes = [node.GetROS2NodeName() for node in slicer.util.getNodesByClass("vtkMRMLROS2NodeNode")
+                            if node.RequiresPolling()]
+            self.assertTrue(pollingNodes == [], "Nodes requiring polling: " + ", ".join(pollingNodes))
+            self.assertTrue(ros2Logic.GetNumberOfComponents() == 0, "Components still loaded")
+            self.assertFalse(ros2Logic.RequiresPolling(), "Idle scene requires polling")
+            # the widget adjusts its timer after each spin
+            widget = slicer.modules.ros2.widgetRepresentation()
+            expectedInterval = int(1000.0 / ros2Logic.GetIdleSpinRate())
+            end = time.time() + 5.0
+            while (widget.timerInterval() != expectedInterval) and (time.time() < end):
+                slicer.app.processEvents()
+                time.sleep(0.01)
+            self.assertTrue(widget.timerInterval() == expectedInterval, "Widget timer not slowed down to the idle rate")
+
+            self.assertTrue(backgroundNode.RemoveAndDeleteSubscriberNode(topic))
+            self.assertTrue(backgroundNode.RemoveAndDeletePublisherNode(topic))
+            backgroundNode.Destroy()
+            print("Testing publisher and subscriber on a node spinning in background - Done")
+
+        def test_spin_budget(self):
+            print("\nTesting spin budget - Starting..")
+            ros2Logic = slicer.util.getModuleLogic('ROS2')
+            self.create_pub_sub("String")
+            initialBudget = ros2Logic.GetSpinBudget()
+
+            # negative budgets are rejected
+            ros2Logic.SetSpinBudget(-1.0)
+            self.assertTrue(ros2Logic.GetSpinBudget() == initialBudget, "Negative budget accepted")
+
+            # a budget too small for any work still makes progress
+            ros2Logic.SetSpinBudget(0.000001)
+            self.assertTrue(ros2Logic.GetSpinBudget() == 0.000001, "Budget not set")
+            ros2Logic.ResetSpinCounters()
+            self.assertTrue(ros2Logic.GetNumberOfSpins() == 0, "Spin counter not reset")
+            self.assertTrue(ros2Logic.GetNumberOfSpinBudgetOverruns() == 0, "Overrun counter not reset")
+            initSubMessageCount = self.testSub.GetNumberOfMessages()
+            for i in range(3):
+                self.testPub.Publish("budget " + str(i))
+            received = ROS2TestsLogic.spin_until(lambda: self.testSub.GetNumberOfMessages() - initSubMessageCount >= 3)
+            numberOfSpins = ros2Logic.GetNumberOfSpins()
+            numberOfOverruns = ros2Logic.GetNumberOfSpinBudgetOverruns()
+            ros2Logic.SetSpinBudget(initialBudget)
+
+            self.assertTrue(received, "Executor starved by the spin budget")
+            self.assertTrue(self.testSub.GetLastMessage() == "budget 2", "Last message incorrect")
+            self.assertTrue(numberOfSpins >= 1, "Spins not counted")
+            self.assertTrue(1 <= numberOfOverruns <= numberOfSpins, "Budget overruns not counted")
+
+            self.delete_pub_sub()
+            print("Testing spin budget - Done")
+
+        def test_trace(self):
+            print("\nTesting trace recording - Starting..")
+            ros2Logic = slicer.util.getModuleLogic('ROS2')
+            self.create_pub_sub("String")
+            traceDirectory = tempfile.mkdtemp()
+            traceFile = os.path.join(traceDirectory, "slicer_ros2_trace.json")
+
+            self.assertTrue(ros2Logic.StartTrace(traceFile), "Trace not started")
+            self.assertTrue(ros2Logic.IsTracing(), "Not tracing")
+            self.assertFalse(ros2Logic.StartTrace(traceFile), "Trace started twice")
+            ros2Logic.TraceBegin("test", "escaped \"name\"")
+            self.testPub.Publish("trace")
+            ROS2TestsLogic.spin_some()
+            ros2Logic.TraceEnd("test", "escaped \"name\"")
+            self.assertTrue(ros2Logic.StopTrace(), "Trace not stopped")
+            self.assertFalse(ros2Logic.IsTracing(), "Still tracing")
+            self.assertFalse(ros2Logic.StopTrace(), "Trace stopped twice")
+
+            self.assertTrue(os.path.isfile(traceFile), "Trace file not written")
+            with open(traceFile) as f:
+                trace = json.load(f)
+            names = [event["name"] for event in trace["traceEvents"]]
+            self.assertTrue("Spin" in names, "Logic spin not traced")
+            self.assertTrue("escaped \"name\"" in names, "User event not traced")
+            self.assertTrue(ros2Logic.GetNumberOfDroppedTraceEvents() == 0, "Events dropped")
+
+            # small buffer, events are dropped but the file is still valid
+            # and every slice is terminated, even if left open at stop
+            self.assertTrue(ros2Logic.StartTrace(traceFile, 4), "Trace not started")
+            ros2Logic.TraceBegin("test", "open")
+            ROS2TestsLogic.spin_some()
+            self.assertTrue(ros2Logic.StopTrace(), "Trace not stopped")
+            ros2Logic.TraceEnd("test", "open")
+            self.assertTrue(ros2Logic.GetNumberOfDroppedTraceEvents() > 0, "Dropped events not counted")
+            with open(traceFile) as f:
+                trace = json.load(f)
+            self.assertTrue(len(trace["traceEvents"]) <= 4, "Trace buffer not capped")
+            phases = [event["ph"] for event in trace["traceEvents"]]
+            self.assertTrue(phases.count("B") == phases.count("E"), "Unterminated slices in capped trace")
+            self.assertTrue("open" in [event["name"] for event in trace["traceEvents"] if event["ph"] == "E"],
+                            "Open slice not closed at stop")
+            self.assertTrue(int(trace["otherData"]["droppedEvents"]) == ros2Logic.GetNumberOfDroppedTraceEvents(),
+                            "Dropped events not saved")
+
+            os.remove(traceFile)
+            os.rmdir(traceDirectory)
+            self.delete_pub_sub()
+            print("Testing trace recording - Done")
+
+        def test_load_unload_component(self):
+            print("\nTesting component load and unload - Starting..")
+            ros2Logic = slicer.util.getModuleLogic('ROS2')
+            initNumberOfComponents = ros2Logic.GetNumberOfComponents()
+            componentId = ros2Logic.LoadComponent("composition", "composition::Talker", "slicer_test_talker", "", False)
+            self.assertTrue(componentId > 0, "Component not loaded")
+            self.assertTrue(ros2Logic.GetNumberOfComponents() == initNumberOfComponents + 1, "Component not counted")
+            # the component's timer is spun by the logic's executor
+            self.assertTrue(ros2Logic.RequiresPolling(), "Loaded component doesn't require polling")
+            ROS2TestsLogic.spin_some()
+
+            self.assertTrue(ros2Logic.UnloadComponent(componentId), "Component not unloaded")
+            self.assertTrue(ros2Logic.GetNumberOfComponents() == initNumberOfComponents, "Component still counted")
+            self.assertFalse(ros2Logic.UnloadComponent(componentId), "Component unloaded twice")
+            self.assertFalse(ros2Logic.LoadComponent("composition", "composition::NotAComponent") > 0,
+                             "Unknown component loaded")
+            self.assertTrue(ros2Logic.GetNumberOfComponents() == initNumberOfComponents, "Failed load counted")
+            print("Testing component load and unload - Done")
+
+        def test_last_message_shared(self):
+            print("\nTesting last message kept by shared pointer - Starting..")
+            self.create_pub_sub("PoseStamped")
+
+            # several messages between spins, only the latest is kept
+            # but all are counted
+            initSubMessageCount = self.testSub.GetNumberOfMessages()
+            sentMatrix = vtk.vtkMatrix4x4()
+            for value in range(3):
+                sentMatrix.SetElement(0, 3, float(value))
+                self.testPub.Publish(sentMatrix)
+            self.assertTrue(ROS2TestsLogic.spin_until(lambda: self.testSub.GetNumberOfMessages() - initSubMessageCount >= 3),
+                            "Messages not received")
+            self.assertTrue(self.testSub.GetNumberOfMessages() - initSubMessageCount == 3, "Messages not counted correctly")
+            lastMessageYAML = self.testSub.GetLastMessageYAML()
+            self.assertTrue(lastMessageYAML != "", "Last message YAML empty")
+
+            # conversion only on demand, once per message
+            numberOfConversions = self.testSub.GetConversionStatistics().GetNumberOfSamples()
+            self.testSub.GetLastMessage()
+            receivedMatrix = self.testSub.GetLastMessage()
+            self.assertTrue(self.testSub.GetConversionStatistics().GetNumberOfSamples() - numberOfConversions == 1,
+                            "Conversion not done on demand")
+            self.assertTrue(receivedMatrix.GetElement(0, 3) == 2.0, "Last message incorrect")
+
+            # a new message replaces the one held
+            sentMatrix.SetElement(0, 3, 3.0)
+            self.testPub.Publish(sentMatrix)
+            self.assertTrue(ROS2TestsLogic.spin_until(lambda: self.testSub.GetNumberOfMessages() - initSubMessageCount >= 4),
+                            "Message not received")
+            receivedMatrix = self.testSub.GetLastMessage()
+            self.assertTrue(self.testSub.GetLastMessageYAML() != lastMessageYAML, "Last message YAML not replaced")
+            self.assertTrue(receivedMatrix.GetElement(0, 3) == 3.0, "Last message not replaced")
+
+            self.delete_pub_sub()
+            print("Testing last message kept by shared pointer - Done")
+
+        def test_coalesce_modified_events(self):
+            print("\nTesting coalesced modified events - Starting..")
+            self.create_pub_sub("String")
+            self.testSub.SetCoalesceModifiedEvents(True)
+
+            initSubMessageCount = self.testSub.GetNumberOfMessages()
+            for i in range(5):
+                self.testPub.Publish("message " + str(i))
+            ROS2TestsLogic.spin_some() # 3 spins
+
+            self.assertTrue(self.testSub.GetNumberOfMessages() - initSubMessageCount == 5, "Messages not received")
+            # at most one modified event per spin
+            self.assertTrue(1 <= self.testObs.counter <= 3, "Modified events not coalesced")
+            self.assertTrue(self.testSub.GetLastMessage() == "message 4", "Last message incorrect")
+
+            self.delete_pub_sub()
+            print("Testing coalesced modified events - Done")
+
+        def test_decimation(self):
+            print("\nTesting subscriber decimation - Starting..")
+            self.create_pub_sub("Int")
+            self.assertFalse(self.testSub.SetDecimationEveryNth(0), "Invalid decimation accepted")
+            self.assertTrue(self.testSub.SetDecimationEveryNth(2))
+
+            initSubMessageCount = self.testSub.GetNumberOfMessages()
+            for i in range(6):
+                self.testPub.Publish(i)
+            ROS2TestsLogic.spin_some()
+
+            self.assertTrue(self.testSub.GetNumberOfMessages() - initSubMessageCount == 3, "Messages not decimated")
+            self.assertTrue(self.testSub.GetNumberOfDroppedMessages() == 3, "Dropped messages not counted")
+            self.assertTrue(self.testSub.GetLastMessage() == 4, "Last message incorrect")
+
+            # minimum change, only the first message is kept
+            self.assertTrue(self.testSub.SetDecimationEveryNth(1))
+            self.assertTrue(self.testSub.SetDecimationMinimumChange(10.0))
+            initSubMessageCount = self.testSub.GetNumberOfMessages()
+            for i in range(3):
+                self.testPub.Publish(20 + i)
+            ROS2TestsLogic.spin_some()
+            self.assertTrue(self.testSub.GetNumberOfMessages() - initSubMessageCount == 1, "Minimum change not applied")
+            self.assertTrue(self.testSub.GetLastMessage() == 20, "Last message incorrect")
+
+            self.delete_pub_sub()
+            print("Testing subscriber decimation - Done")
+
+        def test_generic_subscriber(self):
+            print("\nTesting generic subscriber - Starting..")
+            self.topic = "slicer_test_generic"
+            self.assertIsNone(self.ros2Node.CreateAndAddGenericSubscriberNode("not_a_package/msg/NotAType", self.topic),
+                              "Generic subscriber created for an invalid type")
+            self.testPub = self.ros2Node.CreateAndAddPublisherNode("vtkMRMLROS2PublisherDoubleNode", self.topic)
+            self.testSub = self.ros2Node.CreateAndAddGenericSubscriberNode("std_msgs/msg/Float64", self.topic)
+            self.assertTrue(self.testSub.GetROSType() == "std_msgs/msg/Float64")
+            self.observerId = self.testSub.AddObserver("ModifiedEvent", self.testObs.Callback)
+            ROS2TestsLogic.spin_some()
+
+            initSubMessageCount = self.testSub.GetNumberOfMessages()
+            self.testPub.Publish(12.5)
+            self.generic_assertions(initSubMessageCount)
+            self.assertTrue(self.testSub.GetLastMessageField("data").ToDouble() == 12.5, "Field value incorrect")
+            self.assertFalse(self.testSub.GetLastMessageField("not_a_field").IsValid(), "Invalid field found")
+            table = self.testSub.GetLastMessage()
+            self.assertTrue(table.GetNumberOfRows() == 1)
+            self.assertTrue(table.GetColumnByName("data").GetValue(0) == 12.5, "Table value incorrect")
+            self.assertTrue("12.5" in self.testSub.GetLastMessageYAML(), "YAML incorrect")
+
+            self.delete_pub_sub()
+            print("Testing generic subscriber - Done")
+
+        def test_generic_subscriber_arrays(self):
+            print("\nTesting generic subscriber with arrays - Starting..")
+            self.topic = "slicer_test_generic_arrays"
+            self.testPub = self.ros2Node.CreateAndAddPublisherNode("vtkMRMLROS2PublisherDoubleArrayNode", self.topic)
+            self.testSub = self.ros2Node.CreateAndAddGenericSubscriberNode("std_msgs/msg/Float64MultiArray", self.topic)
+            self.observerId = self.testSub.AddObserver("ModifiedEvent", self.testObs.Callback)
+            ROS2TestsLogic.spin_some()
+
+            initSubMessageCount = self.testSub.GetNumberOfMessages()
+            sentArray = vtk.vtkDoubleArray()
+            for value in [1.5, 2.5, 3.5, 4.5]:
+                sentArray.InsertNextValue(value)
+            self.testPub.Publish(sentArray)
+            self.generic_assertions(initSubMessageCount)
+
+            # one column for the whole sequence, one component per element
+            table = self.testSub.GetLastMessage()
+            self.assertTrue(table.GetNumberOfRows() == 1, "Table should have a single row")
+            dataColumn = table.GetColumnByName("data")
+            self.assertIsNotNone(dataColumn, "No column for the data sequence")
+            self.assertTrue(dataColumn.GetNumberOfComponents() == 4, "Sequence not stored in a single column")
+            for i in range(4):
+                self.assertTrue(dataColumn.GetComponent(0, i) == sentArray.GetValue(i), "Sequence value incorrect")
+            self.assertIsNone(table.GetColumnByName("data[0]"), "Sequence elements stored in separate columns")
+            self.assertIsNotNone(table.GetColumnByName("layout.data_offset"), "Scalar field missing")
+
+            self.delete_pub_sub()
+            print("Testing generic subscriber with arrays - Done")
+
+        def test_generic_publisher(self):
+            print("\nTesting generic publisher - Starting..")
+            self.topic = "slicer_test_generic_publisher"
+            self.testPub = self.ros2Node.CreateAndAddGenericPublisherNode("geometry_msgs/msg/PoseStamped", self.topic)
+            self.testSub = self.ros2Node.CreateAndAddGenericSubscriberNode("geometry_msgs/msg/PoseStamped", self.topic)
+            self.observerId = self.testSub.AddObserver("ModifiedEvent", self.testObs.Callback)
+            ROS2TestsLogic.spin_some()
+
+            self.assertTrue(self.testPub.SetField("header.frame_id", "world"))
+            self.assertTrue(self.testPub.SetField("pose.position.x", 0.25))
+            self.assertFalse(self.testPub.SetField("pose.not_a_field", 1.0), "Invalid field set")
+            self.assertTrue(self.testPub.GetField("pose.position.x").ToDouble() == 0.25)
+
+            initSubMessageCount = self.testSub.GetNumberOfMessages()
+            self.testPub.Publish()
+            self.generic_assertions(initSubMessageCount)
+            self.assertTrue(self.testSub.GetLastMessageField("header.frame_id").ToString() == "world", "String field incorrect")
+            self.assertTrue(self.testSub.GetLastMessageField("pose.position.x").ToDouble() == 0.25, "Number field incorrect")
+
+            # message is reused, only modified fields change
+            self.assertTrue(self.testPub.SetField("pose.position.y", 0.5))
+            self.testPub.Publish()
+            ROS2TestsLogic.spin_some()
+            self.assertTrue(self.testSub.GetLastMessageField("pose.position.x").ToDouble() == 0.25)
+            self.assertTrue(self.testSub.GetLastMessageField("pose.position.y").ToDouble() == 0.5)
+
+            self.delete_pub_sub()
+            print("Testing generic publisher - Done")
+
+        def test_qos_pub_sub(self):
+            print("\nTesting QoS for publisher and subscriber - Starting..")
+            self.testPub = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLROS2PublisherStringNode")
+            self.testSub = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLROS2SubscriberStringNode")
+            self.assertFalse(self.testSub.SetQoSReliability("sometimes"), "Invalid reliability accepted")
+            for node in [self.testPub, self.testSub]:
+                self.assertTrue(node.SetQoSReliability("best_effort"))
+                self.assertTrue(node.SetQoSDepth(1))
+            self.assertTrue(self.testPub.AddToROS2Node(self.ros2Node.GetID(), "slicer_test_qos"))
+            self.assertTrue(self.testSub.AddToROS2Node(self.ros2Node.GetID(), "slicer_test_qos"))
+            self.assertFalse(self.testSub.SetQoSDepth(10), "QoS changed after subscriber added")
+            self.assertTrue(self.testSub.GetQoSReliability() == "best_effort")
+            self.assertTrue(self.testSub.GetQoSDepth() == 1)
+            self.observerId = self.testSub.AddObserver("ModifiedEvent", self.testObs.Callback)
+            self.topic = "slicer_test_qos"
+            ROS2TestsLogic.spin_some()
+
+            initSubMessageCount = self.testSub.GetNumberOfMessages()
+            self.testPub.Publish("xkcd")
+            self.generic_assertions(initSubMessageCount)
+            self.assertTrue(self.testSub.GetLastMessage() == "xkcd", "Message not received correctly")
+
+            self.delete_pub_sub()
+            print("Testing QoS for publisher and subscriber - Done")
+
+        def test_asynchronous_publisher(self):
+            print("\nTesting asynchronous publisher - Starting..")
+            self.topic = "slicer_test_asynchronous"
+            self.testPub = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLROS2PublisherDoubleArrayNode")
+            self.assertFalse(self.testPub.SetQueueOverflowPolicy("sometimes"), "Invalid policy accepted")
+            self.assertTrue(self.testPub.SetAsynchronous(True))
+            self.assertTrue(self.testPub.SetQueueDepth(2))
+            self.assertTrue(self.testPub.SetQueueOverflowPolicy("block"))
+            self.assertTrue(self.testPub.AddToROS2Node(self.ros2Node.GetID(), self.topic))
+            self.assertFalse(self.testPub.SetQueueDepth(5), "Queue depth changed after publisher added")
+            self.testSub = self.ros2Node.CreateAndAddSubscriberNode("vtkMRMLROS2SubscriberDoubleArrayNode", self.topic)
+            ROS2TestsLogic.spin_some()
+
+            initSubMessageCount = self.testSub.GetNumberOfMessages()
+            sentArray = vtk.vtkDoubleArray()
+            sentArray.SetNumberOfValues(3)
+            for i in range(3):
+                for j in range(3):
+                    sentArray.SetValue(j, 10.0 * i + j)
+                self.assertTrue(self.testPub.Publish(sentArray) == 1, "Message not queued")
+            # the publisher works on a copy, changes after Publish are not sent
+            sentArray.SetValue(0, -1.0)
+
+            # the publisher thread and the delivery can be slow on a loaded machine
+            self.assertTrue(ROS2TestsLogic.spin_until(lambda: self.testSub.GetNumberOfMessages() - initSubMessageCount >= 3),
+                            "Messages not received")
+            self.assertTrue(ROS2TestsLogic.spin_until(lambda: self.testPub.GetQueueSize() == 0), "Queue not empty")
+            self.assertTrue(self.testPub.GetNumberOfDroppedMessages() == 0, "Messages dropped with block policy")
+            self.assertTrue(self.testSub.GetNumberOfMessages() - initSubMessageCount == 3, "Too many messages received")
+            receivedArray = self.testSub.GetLastMessage()
+            self.assertTrue(receivedArray.GetNumberOfValues() == 3)
+            self.assertTrue(receivedArray.GetValue(0) == 20.0, "Message not received correctly")
+
+            self.ros2Node.RemoveAndDeleteSubscriberNode(self.topic)
+            self.ros2Node.RemoveAndDeletePublisherNode(self.topic)
+            print("Testing asynchronous publisher - Done")
+
+        def test_observed_node_publisher(self):
+            print("\nTesting publisher observing a MRML node - Starting..")
+            self.topic = "slicer_test_observed"
+            self.testPub = self.ros2Node.CreateAndAddPublisherNode("vtkMRMLROS2PublisherPoseStampedNode", self.topic)
+            self.testSub = self.ros2Node.CreateAndAddSubscriberNode("vtkMRMLROS2SubscriberPoseStampedNode", self.topic)
+            transformNode = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLLinearTransformNode")
+            self.assertTrue(self.testPub.ObserveNode(transformNode))
+            self.assertTrue(self.testPub.GetObservedNode() == transformNode)
+            ROS2TestsLogic.spin_some()
+            initSubMessageCount = self.testSub.GetNumberOfMessages()
+
+            # many modifications between two spins result in a single message
+            matrix = vtk.vtkMatrix4x4()
+            for i in range(10):
+                matrix.SetElement(0, 3, float(i))
+                transformNode.SetMatrixTransformToParent(matrix)
+            self.assertTrue(self.testPub.GetAutoPublishPending())
+            ROS2TestsLogic.spin_some()
+            self.assertFalse(self.testPub.GetAutoPublishPending())
+            self.assertTrue(self.testSub.GetNumberOfMessages() - initSubMessageCount == 1, "Modifications not coalesced")
+            self.assertTrue(self.testSub.GetLastMessage().GetElement(0, 3) == 9.0, "Last modification not published")
+
+            self.assertTrue(self.testPub.ObserveNode(None))
+            transformNode.SetMatrixTransformToParent(vtk.vtkMatrix4x4())
+            self.assertFalse(self.testPub.GetAutoPublishPending(), "Node still observed")
+
+            slicer.mrmlScene.RemoveNode(transformNode)
+            self.ros2Node.RemoveAndDeleteSubscriberNode(self.topic)
+            self.ros2Node.RemoveAndDeletePublisherNode(self.topic)
+            print("Testing publisher observing a MRML node - Done")
+
+        def test_driven_node_subscriber(self):
+            print("\nTesting subscriber driving a MRML node - Starting..")
+            self.topic = "slicer_test_driven"
+            self.testPub = self.ros2Node.CreateAndAddPublisherNode("vtkMRMLROS2PublisherPoseStampedNode", self.topic)
+            self.testSub = self.ros2Node.CreateAndAddSubscriberNode("vtkMRMLROS2SubscriberPoseStampedNode", self.topic)
+            transformNode = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLLinearTransformNode")
+            self.assertTrue(self.testSub.DriveNode(transformNode))
+            self.assertTrue(self.testSub.GetDrivenNode() == transformNode)
+            ROS2TestsLogic.spin_some()
+
+            sentMatrix = vtk.vtkMatrix4x4()
+            sentMatrix.SetElement(1, 3, 42.0)
+            self.testPub.Publish(sentMatrix)
+            ROS2TestsLogic.spin_some()
+            drivenMatrix = vtk.vtkMatrix4x4()
+            transformNode.GetMatrixTransformToParent(drivenMatrix)
+            self.assertTrue(drivenMatrix.GetElement(1, 3) == 42.0, "Driven transform not updated")
+
+            self.ros2Node.RemoveAndDeleteSubscriberNode(self.topic)
+            self.ros2Node.RemoveAndDeletePublisherNode(self.topic)
+
+            # numbers are written in a table row
+            self.topic = "slicer_test_driven_table"
+            self.testPub = self.ros2Node.CreateAndAddPublisherNode("vtkMRMLROS2PublisherDoubleNode", self.topic)
+            self.testSub = self.ros2Node.CreateAndAddSubscriberNode("vtkMRMLROS2SubscriberDoubleNode", self.topic)
+            tableNode = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLTableNode")
+            self.assertTrue(self.testSub.DriveNode(tableNode))
+            self.testSub.SetDrivenTableRow(2)
+            ROS2TestsLogic.spin_some()
+            self.testPub.Publish(3.5)
+            ROS2TestsLogic.spin_some()
+            self.assertTrue(tableNode.GetTable().GetNumberOfRows() == 3, "Driven row not added")
+            self.assertTrue(tableNode.GetTable().GetValue(2, 0).ToDouble() == 3.5, "Driven table not updated")
+
+            slicer.mrmlScene.RemoveNode(transformNode)
+            slicer.mrmlScene.RemoveNode(tableNode)
+            self.ros2Node.RemoveAndDeleteSubscriberNode(self.topic)
+            self.ros2Node.RemoveAndDeletePublisherNode(self.topic)
+            print("Testing subscriber driving a MRML node - Done")
+
+        def test_image_subscriber(self):
+            print("\nTesting image subscriber - Starting..")
+            self.topic = "slicer_test_image"
+            self.testPub = self.ros2Node.CreateAndAddGenericPublisherNode("sensor_msgs/msg/Image", self.topic)
+            self.testSub = self.ros2Node.CreateAndAddSubscriberNode("vtkMRMLROS2SubscriberImageNode", self.topic)
+            self.observerId = self.testSub.AddObserver("ModifiedEvent", self.testObs.Callback)
+            volumeNode = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLVectorVolumeNode")
+            frameNode = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLLinearTransformNode", "slicer_test_probe")
+            self.assertTrue(self.testSub.DriveNode(volumeNode))
+            ROS2TestsLogic.spin_some()
+
+            # 3 x 2 bgr8 image, rows padded to 12 bytes
+            self.assertTrue(self.testPub.SetField("header.frame_id", "slicer_test_probe"))
+            self.assertTrue(self.testPub.SetField("width", 3))
+            self.assertTrue(self.testPub.SetField("height", 2))
+            self.assertTrue(self.testPub.SetField("encoding", "bgr8"))
+            self.assertTrue(self.testPub.SetField("step", 12))
+            for i in range(24):
+                self.assertTrue(self.testPub.SetField("data[%d]" % i, i))
+            initSubMessageCount = self.testSub.GetNumberOfMessages()
+            self.testPub.Publish()
+            self.generic_assertions(initSubMessageCount)
+
+            imageData = volumeNode.GetImageData()
+            self.assertTrue(imageData.GetDimensions() == (3, 2, 1), "Image dimensions incorrect")
+            self.assertTrue(imageData.GetNumberOfScalarComponents() == 3, "Image components incorrect")
+            for row in range(2):
+                for column in range(3):
+                    for component in range(3):
+                        expected = row * 12 + column * 3 + (2 - component)
+                        self.assertTrue(imageData.GetScalarComponentAsDouble(column, row, 0, component) == expected,
+                                        "Image not received correctly")
+            self.assertTrue(volumeNode.GetParentTransformNode() == frameNode, "Image not placed in its frame")
+
+            slicer.mrmlScene.RemoveNode(volumeNode)
+            slicer.mrmlScene.RemoveNode(frameNode)
+            self.delete_pub_sub()
+            print("Testing image subscriber - Done")
+
+        def test_image_publisher(self):
+            print("\nTesting image publisher - Starting..")
+            self.create_pub_sub("Image")
+
+            for scalarType, numberOfComponents in [(vtk.VTK_UNSIGNED_SHORT, 1), (vtk.VTK_UNSIGNED_CHAR, 3)]:
+                initSubMessageCount = self.testSub.GetNumberOfMessages()
+                image = vtk.vtkImageData()
+                image.SetDimensions(5, 4, 1)
+                image.AllocateScalars(scalarType, numberOfComponents)
+                scalars = image.GetPointData().GetScalars()
+                for i in range(scalars.GetNumberOfValues()):
+                    scalars.SetValue(i, (7 * i) % 250)
+                self.testPub.Publish(image)
+                self.generic_assertions(initSubMessageCount)
+
+                receivedImage = self.testSub.GetLastMessage()
+                self.assertTrue(receivedImage.GetDimensions() == (5, 4, 1), "Image dimensions incorrect")
+                receivedScalars = receivedImage.GetPointData().GetScalars()
+                self.assertTrue(receivedScalars.GetDataType() == scalarType, "Image encoding incorrect")
+                self.assertTrue(receivedScalars.GetNumberOfComponents() == numberOfComponents, "Image encoding incorrect")
+                for i in range(scalars.GetNumberOfValues()):
+                    self.assertTrue(receivedScalars.GetValue(i) == scalars.GetValue(i), "Image not received correctly")
+
+            # unsupported scalar type after a valid image, nothing is sent
+            initSubMessageCount = self.testSub.GetNumberOfMessages()
+            image = vtk.vtkImageData()
+            image.SetDimensions(5, 4, 1)
+            image.AllocateScalars(vtk.VTK_DOUBLE, 2)
+            self.assertTrue(self.testPub.Publish(image) == 0, "Unsupported image published")
+            ROS2TestsLogic.spin_some()
+            self.assertTrue(self.testSub.GetNumberOfMessages() == initSubMessageCount, "Unsupported image received")
+
+            self.delete_pub_sub()
+            print("Testing image publisher - Done")
+
+        def test_subscriber_history(self):
+            print("\nTesting subscriber history - Starting..")
+            self.topic = "slicer_test_history"
+            self.testPub = self.ros2Node.CreateAndAddPublisherNode("vtkMRMLROS2PublisherDoubleNode", self.topic)
+            self.testSub = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLROS2SubscriberDoubleNode")
+            self.assertTrue(self.testSub.SetHistoryDepth(10))
+            self.assertTrue(self.testSub.AddToROS2Node(self.ros2Node.GetID(), self.topic))
+            self.assertFalse(self.testSub.SetHistoryDepth(20), "History depth changed after subscriber added")
+            self.observerId = self.testSub.AddObserver("ModifiedEvent", self.testObs.Callback)
+            ROS2TestsLogic.spin_some()
+
+            sentValues = [1.5, 2.5, 3.5]
+            for value in sentValues:
+                self.testPub.Publish(value)
+                ROS2TestsLogic.spin_some()
+
+            table = vtk.vtkTable()
+            self.assertTrue(self.testSub.GetHistoryAsTable(table) == 3, "History size incorrect")
+            self.assertTrue(table.GetNumberOfRows() == 3)
+            values = table.GetColumnByName("value")
+            versions = table.GetColumnByName("version")
+            for row in range(3):
+                self.assertTrue(values.GetValue(row) == sentValues[row], "History value incorrect")
+            # only the messages after the first one
+            self.assertTrue(self.testSub.GetMessagesSince(versions.GetValue(0), table) == 2, "GetMessagesSince incorrect")
+            self.assertTrue(table.GetColumnByName("value").GetValue(0) == sentValues[1])
+
+            self.delete_pub_sub()
+            print("Testing subscriber history - Done")
+
+        def test_background_subscriber_history(self):
+            print("\nTesting subscriber history on a node spinning in background - Starting..")
+            backgroundNode = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLROS2NodeNode")
+            backgroundNode.Create("testBackgroundHistoryNode", True)
+            topic = "slicer_test_background_history"
+            testPub = backgroundNode.CreateAndAddPublisherNode("vtkMRMLROS2PublisherIntNode", topic)
+            testSub = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLROS2SubscriberIntNode")
+            depth = 3
+            self.assertTrue(testSub.SetHistoryDepth(depth))
+            self.assertTrue(testSub.AddToROS2Node(backgroundNode.GetID(), topic))
+            self.assertTrue(ROS2TestsLogic.spin_until(lambda: testPub.Publish(-1) >= 1), "Subscriber not matched")
+            self.assertTrue(ROS2TestsLogic.spin_until(lambda: testSub.GetLastMessage() == -1), "Message not received")
+            ROS2TestsLogic.spin_some()
+
+            # more messages than the history depth between two spins, the
+            # oldest ones are replaced.  Don't spin (nor process events)
+            # while waiting so the history is not drained.
+            initDropped = testSub.GetNumberOfDroppedHistoryMessages()
+            numberOfValues = 10
+            for value in range(numberOfValues):
+                testPub.Publish(value)
+            end = time.time() + 5.0
+            while (testSub.GetNumberOfDroppedHistoryMessages() - initDropped < numberOfValues - depth) and (time.time() < end):
+                time.sleep(0.01)
+            ROS2TestsLogic.spin_some()
+            self.assertTrue(testSub.GetLastMessage() == numberOfValues - 1, "Last message incorrect")
+            self.assertTrue(testSub.GetNumberOfDroppedHistoryMessages() - initDropped == numberOfValues - depth,
+                            "Dropped history messages not counted")
+
+            table = vtk.vtkTable()
+            self.assertTrue(testSub.GetHistoryAsTable(table) == depth, "History size incorrect")
+            values = table.GetColumnByName("value")
+            versions = table.GetColumnByName("version")
+            self.assertTrue([values.GetValue(row) for row in range(depth)] == list(range(numberOfValues - depth, numberOfValues)),
+                            "History doesn't end with the latest messages")
+            self.assertTrue(versions.GetValue(depth - 1) == testSub.GetLastMessageVersion(), "Latest history version incorrect")
+
+            backgroundNode.Destroy()
+            ROS2TestsLogic.spin_some()
+            print("Testing subscriber history on a node spinning in background - Done")
+
+        def test_intra_process_pub_sub(self):
+            print("\nTesting intra-process publisher and subscriber - Starting..")
+            intraProcessNode = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLROS2NodeNode")
+            intraProcessNode.Create("testNodeIntraProcess", False, True)
+            self.assertTrue(intraProcessNode.GetIntraProcess(), "Intra-process not enabled")
+            ROS2TestsLogic.spin_some()
+            testPub = intraProcessNode.CreateAndAddPublisherNode("vtkMRMLROS2PublisherStringNode", "slicer_test_intra_process")
+            testSub = intraProcessNode.CreateAndAddSubscriberNode("vtkMRMLROS2SubscriberStringNode", "slicer_test_intra_process")
+            ROS2TestsLogic.spin_some()
+
+            initSubMessageCount = testSub.GetNumberOfMessages()
+            testPub.Publish("xkcd")
+            ROS2TestsLogic.spin_some()
+            self.assertTrue(testSub.GetNumberOfMessages() - initSubMessageCount == 1, "Message not received")
+            self.assertTrue(testSub.GetLastMessage() == "xkcd", "Message not received correctly")
+
+            intraProcessNode.Destroy()
+            ROS2TestsLogic.spin_some()
+            print("Testing intra-process publisher and subscriber - Done")
+
         def test_pub_sub_deletion(self):
             print("\nTesting deletion of publisher and subscriber - Starting..")
             testPub = self.ros2Node.CreateAndAddPublisherNode(
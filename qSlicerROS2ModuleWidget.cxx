@@ -17,6 +17,7 @@
 
 // Qt includes
 #include <QTimer>
+#include <QSocketNotifier>
 #include <QDebug>
 #include <QtGui>
 #include <QCloseEvent>
@@ -114,6 +115,15 @@ void qSlicerROS2ModuleWidget::setup(void)
     qWarning() << Q_FUNC_INFO << " failed: Invalid SlicerROS2 logic";
     return;
   }
+
+  // Spin as soon as messages received in background are available
+  const int wakeupFileDescriptor = logic->GetWakeupFileDescriptor();
+  if (wakeupFileDescriptor >= 0) {
+    mWakeupNotifier = new QSocketNotifier(wakeupFileDescriptor, QSocketNotifier::Read, this);
+    connect(mWakeupNotifier, SIGNAL(activated(int)), this, SLOT(onWakeup()));
+  }
+  mTimeSinceLastSpin.start();
+  updateTimerInterval();
   this->qvtkConnect(logic->mDefaultROS2Node, vtkMRMLNode::ReferenceAddedEvent,this, SLOT(updateWidget()));
   this->qvtkConnect(logic->mDefaultROS2Node, vtkMRMLNode::ReferenceRemovedEvent,this, SLOT(updateWidget()));
   updateWidget(); // if the scene is loaded before the widget is activated
@@ -128,6 +138,67 @@ void qSlicerROS2ModuleWidget::onTimerTimeOut()
     return;
   }
   logic->Spin();
+  mTimeSinceLastSpin.restart();
+  updateTimerInterval();
+  // the wakeup has been handled by this spin
+  if (mWakeupNotifier && !mWakeupSpinScheduled) {
+    mWakeupNotifier->setEnabled(true);
+  }
+}
+
+
+void qSlicerROS2ModuleWidget::onWakeup(void)
+{
+  vtkSlicerROS2Logic* logic = vtkSlicerROS2Logic::SafeDownCast(this->logic());
+  if (!logic) {
+    qWarning() << Q_FUNC_INFO << " failed: Invalid SlicerROS2 logic";
+    return;
+  }
+  // the file descriptor stays readable until the logic spins, ignore
+  // further notifications until then
+  mWakeupNotifier->setEnabled(false);
+  const qint64 minimumPeriod = static_cast<qint64>(1000.0 / logic->GetMaximumSpinRate());
+  const qint64 elapsed = mTimeSinceLastSpin.elapsed();
+  if (elapsed >= minimumPeriod) {
+    onTimerTimeOut();
+  } else if (!mWakeupSpinScheduled) {
+    // respect the maximum spin rate
+    mWakeupSpinScheduled = true;
+    QTimer::singleShot(static_cast<int>(minimumPeriod - elapsed), this, SLOT(onScheduledSpin()));
+  }
+}
+
+
+void qSlicerROS2ModuleWidget::onScheduledSpin(void)
+{
+  mWakeupSpinScheduled = false;
+  if (!timerOff) {
+    onTimerTimeOut();
+  }
+}
+
+
+int qSlicerROS2ModuleWidget::timerInterval(void) const
+{
+  return mTimer->interval();
+}
+
+
+void qSlicerROS2ModuleWidget::updateTimerInterval(void)
+{
+  vtkSlicerROS2Logic* logic = vtkSlicerROS2Logic::SafeDownCast(this->logic());
+  if (!logic) {
+    return;
+  }
+  // without wakeup notifications, we have to poll at the maximum rate
+  double rate = logic->GetMaximumSpinRate();
+  if (mWakeupNotifier && !logic->RequiresPolling()) {
+    rate = logic->GetIdleSpinRate();
+  }
+  const int interval = static_cast<int>(1000.0 / rate);
+  if (mTimer->interval() != interval) {
+    mTimer->setInterval(interval);
+  }
 }
 
 
@@ -378,6 +449,10 @@ void qSlicerROS2ModuleWidget::publisherClicked(int row, int col)
 void qSlicerROS2ModuleWidget::stopTimer(void) // Shouldn't be on quit - look here: https://doc.qt.io/qt-5/qapplication.html
 {
   mTimer->stop();
+  timerOff = true;
+  if (mWakeupNotifier) {
+    mWakeupNotifier->setEnabled(false);
+  }
 }
 
 
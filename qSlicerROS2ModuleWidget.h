@@ -24,6 +24,7 @@
 
 // Qt includes
 #include <QFileDialog>
+#include <QElapsedTimer>
 
 class qSlicerROS2ModuleWidgetPrivate;
 class vtkMRMLNode;
@@ -32,6 +33,7 @@ class vtkMRMLROS2PublisherNode;
 class vtkMRMLROS2RobotNode;
 class QLineEdit;
 class QPushButton;
+class QSocketNotifier;
 
 /// \ingroup Slicer_QtModules_ExtensionTemplate
 class Q_SLICER_QTMODULES_ROS2_EXPORT qSlicerROS2ModuleWidget :
@@ -44,6 +46,10 @@ public:
   qSlicerROS2ModuleWidget(QWidget *parent=0);
   virtual ~qSlicerROS2ModuleWidget();
 
+  /*! Current interval (in ms) of the timer used to spin the logic,
+    see vtkSlicerROS2Logic::GetIdleSpinRate. */
+  Q_INVOKABLE int timerInterval(void) const;
+
 public slots:
   void stopTimer(void);
 
@@ -54,8 +60,19 @@ protected:
   QTimer* mTimer;
   bool timerOff = false;
 
+  // wakeup when ROS messages are received in background
+  QSocketNotifier * mWakeupNotifier = nullptr;
+  QElapsedTimer mTimeSinceLastSpin;
+  bool mWakeupSpinScheduled = false;
+
+  /*! Set the timer interval based on the logic's maximum and idle
+    spin rates. */
+  void updateTimerInterval(void);
+
 protected slots:
   void onTimerTimeOut(void);
+  void onWakeup(void);
+  void onScheduledSpin(void);
   void updateWidget(void);
   void updateSubscriberTable(vtkMRMLROS2SubscriberNode * sub, size_t row);
   void updatePublisherTable(vtkMRMLROS2PublisherNode * sub, size_t row);